@@ -0,0 +1,288 @@
+/*
+  ==============================================================================
+
+    AutoDJ.cpp
+    Created: 20 Oct 2026 3:18:44am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AutoDJ.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    //how often the playheads are checked and the crossfade moves
+    constexpr int tickIntervalMs = 50;
+
+    //start of a prepared track kept decoded, covers the crossfade and a seek or two after it
+    constexpr double heldSeconds = 20.0;
+
+    //same resolution as WaveformDisplay, so the deck finds the thumbnail built ahead
+    constexpr int samplesPerThumbSample = 1000;
+
+    //a track ending closer than this stopped by itself
+    constexpr double endToleranceSeconds = 0.1;
+}
+
+AutoDJ::AutoDJ(DeckGUI& _leftDeck, DeckGUI& _rightDeck, AudioFormatManager& _formatManager,
+               AudioThumbnailCache& _thumbCache, DecodedBlockCache& _blockCache, TrackAnalyser& _trackAnalyser)
+    : leftDeck(_leftDeck), rightDeck(_rightDeck), formatManager(_formatManager),
+      thumbCache(_thumbCache), blockCache(_blockCache), trackAnalyser(_trackAnalyser)
+{
+}
+
+AutoDJ::~AutoDJ()
+{
+    stopTimer();
+    preparePool.removeAllJobs(true, 4000);
+}
+
+void AutoDJ::start(const std::vector<Entry>& tracks)
+{
+    queue.clear();
+    for (const auto& entry : tracks)
+    {
+        QueuedTrack queued;
+        queued.entry = entry;
+        queued.serial = nextSerial++;
+        queue.push_back(std::move(queued));
+    }
+
+    activeDeck = -1;
+    fadeStartMs = -1.0;
+    waitingLogged = false;
+    std::cout << "AutoDJ::start - " << queue.size() << " tracks, look-ahead " << lookAhead << std::endl;
+
+    prepareAhead();
+    startTimer(tickIntervalMs);
+}
+
+void AutoDJ::stop()
+{
+    if (!isTimerRunning())
+        return;
+    stopTimer();
+
+    //a crossfade half done ends on the incoming deck
+    if (fadeStartMs >= 0.0)
+    {
+        getDeck(activeDeck).setPlaying(false);
+        activeDeck = 1 - activeDeck;
+        getDeck(activeDeck).setVolume(deckVolume);
+        fadeStartMs = -1.0;
+    }
+
+    //tracks being prepared are dropped when they come back
+    preparePool.removeAllJobs(false, 0);
+    queue.clear();
+
+    if (onStopped != nullptr)
+        onStopped();
+}
+
+void AutoDJ::setLookAhead(int numTracks)
+{
+    lookAhead = jmax(1, numTracks);
+    if (isRunning())
+        prepareAhead();
+}
+
+//==============================================================================
+void AutoDJ::prepareAhead()
+{
+    int numAhead = jmin(lookAhead, static_cast<int>(queue.size()));
+    for (int index = 0; index < numAhead; ++index)
+    {
+        QueuedTrack& queued = queue[static_cast<size_t>(index)];
+        if (!queued.preparing && queued.prepared == nullptr && !queued.failed)
+        {
+            queued.preparing = true;
+            preparePool.addJob([this, serial = queued.serial, file = queued.entry.file, hash = queued.entry.contentHash]
+            {
+                //both players open files the same way, either can prepare
+                Result result{ serial, leftDeck.getPlayer()->prepareURL(URL(file), hash), {} };
+                if (result.prepared != nullptr && result.prepared->track != nullptr)
+                {
+                    auto& track = *result.prepared->track;
+                    int numBlocks = jmin(track.getNumBlocks(), static_cast<int>(std::ceil(
+                        heldSeconds * track.getSampleRate() / DecodedBlockCache::blockSize)));
+                    for (int block = 0; block < numBlocks; ++block)
+                        result.heldBlocks.push_back(blockCache.getBlock(track, block));
+                }
+
+                const ScopedLock sl(resultLock);
+                results.push_back(std::move(result));
+            });
+        }
+
+        //tracks the library has no beat grid for are analysed before they play
+        if (!queued.entry.beatGrid.isValid() && !queued.analysing)
+        {
+            queued.analysing = true;
+            trackAnalyser.analyseAsync(queued.entry.file,
+                [weakThis = WeakReference<AutoDJ>(this), serial = queued.serial](const BeatGrid& grid)
+                {
+                    if (weakThis == nullptr || !grid.isValid())
+                        return;
+
+                    for (auto& track : weakThis->queue)
+                    {
+                        if (track.serial != serial)
+                            continue;
+
+                        track.entry.beatGrid = grid;
+                        if (weakThis->onTrackAnalysed != nullptr)
+                            weakThis->onTrackAnalysed(track.entry.id, grid);
+                        break;
+                    }
+                });
+        }
+    }
+}
+
+void AutoDJ::collectResults()
+{
+    std::vector<Result> ready;
+    {
+        const ScopedLock sl(resultLock);
+        ready.swap(results);
+    }
+
+    for (auto& result : ready)
+    {
+        auto queued = std::find_if(queue.begin(), queue.end(),
+                                   [&result](const QueuedTrack& track) { return track.serial == result.serial; });
+        //stopped or restarted since
+        if (queued == queue.end())
+            continue;
+
+        queued->preparing = false;
+        if (result.prepared == nullptr)
+        {
+            std::cout << "AutoDJ::collectResults - can't open " << queued->entry.file.getFullPathName() << std::endl;
+            queued->failed = true;
+            continue;
+        }
+
+        //reading the waveform goes through the blocks held and a private reader for the rest
+        if (result.prepared->track != nullptr && result.prepared->thumbnailHash != 0)
+        {
+            queued->thumbnail = std::make_unique<AudioThumbnail>(samplesPerThumbSample, formatManager, thumbCache);
+            queued->thumbnail->setReader(new DecodedBlockReader(blockCache, result.prepared->track, false),
+                                         result.prepared->thumbnailHash);
+        }
+        queued->prepared = std::move(result.prepared);
+        queued->heldBlocks = std::move(result.heldBlocks);
+    }
+}
+
+//==============================================================================
+void AutoDJ::timerCallback()
+{
+    collectResults();
+
+    //tracks that can't be opened are skipped
+    while (!queue.empty() && queue.front().failed)
+        queue.pop_front();
+    prepareAhead();
+
+    if (activeDeck < 0)
+    {
+        if (queue.empty())
+            stop();
+        else
+            startNext();
+        return;
+    }
+
+    DJAudioPlayer& player = *getDeck(activeDeck).getPlayer();
+    double length = player.getLengthInSeconds();
+    double remaining = length * (1.0 - player.getPositionRelative());
+
+    if (fadeStartMs < 0.0)
+    {
+        bool ended = !player.isPlaying() && remaining <= endToleranceSeconds;
+
+        //stopped by hand, Auto-DJ stops with it
+        if (!player.isPlaying() && !ended)
+        {
+            stop();
+            return;
+        }
+
+        if (remaining <= jmin(crossfadeSeconds, length / 2.0) || ended)
+        {
+            if (queue.empty())
+            {
+                if (ended)
+                    stop();
+            }
+            else
+            {
+                startNext();
+            }
+        }
+        return;
+    }
+
+    //equal power, the sum stays as loud through the fade
+    double progress = fadeSeconds > 0.0
+        ? jlimit(0.0, 1.0, (Time::getMillisecondCounterHiRes() - fadeStartMs) / (fadeSeconds * 1000.0))
+        : 1.0;
+    int incoming = 1 - activeDeck;
+    getDeck(activeDeck).setVolume(deckVolume * std::cos(progress * MathConstants<double>::halfPi));
+    getDeck(incoming).setVolume(deckVolume * std::sin(progress * MathConstants<double>::halfPi));
+
+    if (progress >= 1.0)
+    {
+        getDeck(activeDeck).setPlaying(false);
+        activeDeck = incoming;
+        fadeStartMs = -1.0;
+    }
+}
+
+bool AutoDJ::startNext()
+{
+    QueuedTrack& next = queue.front();
+    if (next.prepared == nullptr)
+    {
+        //the look-ahead wasn't enough for this drive, the transition waits
+        if (!waitingLogged)
+            std::cout << "AutoDJ::startNext - waiting for " << next.entry.file.getFileName() << std::endl;
+        waitingLogged = true;
+        return false;
+    }
+
+    if (activeDeck < 0)
+    {
+        leftDeck.loadPrepared(std::move(next.prepared), next.entry.beatGrid);
+        leftDeck.setVolume(deckVolume);
+        leftDeck.setPlaying(true);
+        activeDeck = 0;
+    }
+    else
+    {
+        DJAudioPlayer& outgoing = *getDeck(activeDeck).getPlayer();
+        double remaining = outgoing.getLengthInSeconds() * (1.0 - outgoing.getPositionRelative());
+
+        //loading resets the deck's volume, the fade starts the incoming deck silent
+        DeckGUI& incoming = getDeck(1 - activeDeck);
+        deckVolume = getDeck(activeDeck).getVolume();
+        incoming.loadPrepared(std::move(next.prepared), next.entry.beatGrid);
+        incoming.setVolume(0.0);
+        incoming.setPlaying(true);
+
+        fadeStartMs = Time::getMillisecondCounterHiRes();
+        fadeSeconds = outgoing.isPlaying() ? jmin(crossfadeSeconds, remaining) : 0.0;
+    }
+
+    std::cout << "AutoDJ::startNext - " << next.entry.file.getFileName()
+              << (waitingLogged ? ", late" : ", prepared ahead") << std::endl;
+    waitingLogged = false;
+    queue.pop_front();
+    return true;
+}
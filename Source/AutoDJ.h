@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    AutoDJ.h
+    Created: 20 Oct 2026 3:18:44am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "DeckGUI.h"
+#include "DecodedBlockCache.h"
+#include "TrackAnalyser.h"
+#include "TrackTable.h"
+
+/** Plays a queue of tracks through the two decks, crossfading from one into
+    the next near the end of each.
+
+    The next few tracks, the look-ahead, are prepared long before their turn:
+    opened through DJAudioPlayer::prepareURL on a background thread with the
+    start of their audio decoded and held in the block cache, their waveform
+    built into the thumbnail cache and their beat grid analysed when the
+    library has none. A transition then only swaps sources on the message
+    thread, so files on slow network mounts or USB sticks never hold it up.
+    A track that isn't ready in time plays once it is, and is logged. **/
+class AutoDJ : private Timer
+{
+public:
+    using TrackId = TrackTable::TrackId;
+
+    struct Entry
+    {
+        TrackId id = -1;
+        File file;
+        BeatGrid beatGrid;      // empty until analysed
+        uint64 contentHash = 0; // 0 when the library has none, the file is fingerprinted
+    };
+
+    /** Called on the message thread with the beat grid of a queued track
+    analysed ahead of its turn **/
+    std::function<void(TrackId id, const BeatGrid& beatGrid)> onTrackAnalysed;
+
+    /** Called on the message thread when the queue has played out or stop is called **/
+    std::function<void()> onStopped;
+
+    AutoDJ(DeckGUI& leftDeck, DeckGUI& rightDeck, AudioFormatManager& formatManager,
+           AudioThumbnailCache& thumbCache, DecodedBlockCache& blockCache, TrackAnalyser& trackAnalyser);
+    ~AutoDJ() override;
+
+    /** Play the tracks in order from the first, on the left deck **/
+    void start(const std::vector<Entry>& tracks);
+
+    /** Stop following the queue, the decks keep playing **/
+    void stop();
+
+    bool isRunning() const { return isTimerRunning(); }
+
+    /** Number of tracks after the one playing that are kept prepared **/
+    void setLookAhead(int numTracks);
+    int getLookAhead() const { return lookAhead; }
+
+    void setCrossfadeSeconds(double seconds) { crossfadeSeconds = jmax(0.0, seconds); }
+
+private:
+    struct QueuedTrack
+    {
+        Entry entry;
+        int serial = 0;
+        bool preparing = false;
+        bool analysing = false;
+        std::unique_ptr<PreparedTrack> prepared;
+        //the start of the track, kept decoded until it has played
+        std::vector<DecodedBlockCache::BlockPtr> heldBlocks;
+        //built into the thumbnail cache, the deck's waveform finds it there
+        std::unique_ptr<AudioThumbnail> thumbnail;
+        bool failed = false;
+    };
+
+    struct Result
+    {
+        int serial;
+        std::unique_ptr<PreparedTrack> prepared;
+        std::vector<DecodedBlockCache::BlockPtr> heldBlocks;
+    };
+
+    void timerCallback() override;
+
+    /** Queue preparing and analysing for the tracks in the look-ahead **/
+    void prepareAhead();
+
+    /** Hand the tracks prepared on the pool to their place in the queue **/
+    void collectResults();
+
+    /** Load the front of the queue on the idle deck and start fading to it **/
+    bool startNext();
+
+    DeckGUI& getDeck(int index) { return index == 0 ? leftDeck : rightDeck; }
+
+    DeckGUI& leftDeck;
+    DeckGUI& rightDeck;
+    AudioFormatManager& formatManager;
+    AudioThumbnailCache& thumbCache;
+    DecodedBlockCache& blockCache;
+    TrackAnalyser& trackAnalyser;
+
+    //one file at a time, a slow drive is read in queue order
+    ThreadPool preparePool{ 1 };
+
+    //front is the next track to play, the one playing isn't in it
+    std::deque<QueuedTrack> queue;
+    int nextSerial = 0;
+
+    CriticalSection resultLock;
+    std::vector<Result> results;
+
+    int lookAhead = 2;
+    double crossfadeSeconds = 8.0;
+
+    //deck playing, -1 before the first track started
+    int activeDeck = -1;
+    double fadeStartMs = -1.0;
+    double fadeSeconds = 0.0;
+    double deckVolume = 0.5;
+    bool waitingLogged = false;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (AutoDJ)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AutoDJ)
+};
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    BeatGrid.cpp
+    Created: 19 Oct 2026 9:41:05am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include "BeatGrid.h"
+#include <algorithm>
+#include <cmath>
+
+BeatGrid::BeatGrid(double sampleRate, double firstBeatSample, double bpm)
+{
+    if (sampleRate > 0.0 && bpm > 0.0)
+    {
+        this->sampleRate = sampleRate;
+        segments.push_back({ 0.0, firstBeatSample, sampleRate * 60.0 / bpm });
+    }
+}
+
+void BeatGrid::addTempoChange(int64_t beatIndex, double bpm)
+{
+    //tempo changes can only follow the last segment
+    if (! isValid() || bpm <= 0.0 || beatIndex <= segments.back().startBeat)
+        return;
+
+    double beat = static_cast<double>(beatIndex);
+    segments.push_back({ beat, getSampleForBeat(beat), sampleRate * 60.0 / bpm });
+}
+
+double BeatGrid::getBpmAt(int64_t samplePos) const
+{
+    if (! isValid())
+        return 0.0;
+
+    return sampleRate * 60.0 / segmentForSample(static_cast<double>(samplePos)).samplesPerBeat;
+}
+
+double BeatGrid::getSamplesPerBeatAt(int64_t samplePos) const
+{
+    if (! isValid())
+        return 0.0;
+
+    return segmentForSample(static_cast<double>(samplePos)).samplesPerBeat;
+}
+
+double BeatGrid::getBeatPosition(double samplePos) const
+{
+    if (! isValid())
+        return 0.0;
+
+    //samples before the first beat are extrapolated with the first tempo
+    const Segment& segment = segmentForSample(samplePos);
+    return segment.startBeat + (samplePos - segment.startSample) / segment.samplesPerBeat;
+}
+
+double BeatGrid::getSampleForBeat(double beat) const
+{
+    if (! isValid())
+        return 0.0;
+
+    const Segment& segment = segmentForBeat(beat);
+    return segment.startSample + (beat - segment.startBeat) * segment.samplesPerBeat;
+}
+
+int64_t BeatGrid::getNextBeatAfter(int64_t samplePos) const
+{
+    if (! isValid())
+        return -1;
+
+    double beat = std::floor(getBeatPosition(static_cast<double>(samplePos))) + 1.0;
+    int64_t beatSample = static_cast<int64_t>(std::llround(getSampleForBeat(beat)));
+
+    //rounding can land on samplePos itself when it sits right on a beat
+    if (beatSample <= samplePos)
+        beatSample = static_cast<int64_t>(std::llround(getSampleForBeat(beat + 1.0)));
+
+    return beatSample;
+}
+
+int64_t BeatGrid::getBeatAtOrBefore(int64_t samplePos) const
+{
+    if (! isValid())
+        return -1;
+
+    double beat = std::floor(getBeatPosition(static_cast<double>(samplePos)));
+    int64_t beatSample = static_cast<int64_t>(std::llround(getSampleForBeat(beat)));
+
+    if (beatSample > samplePos)
+        beatSample = static_cast<int64_t>(std::llround(getSampleForBeat(beat - 1.0)));
+
+    return beatSample;
+}
+
+int64_t BeatGrid::getNearestBeat(int64_t samplePos) const
+{
+    if (! isValid())
+        return -1;
+
+    double beat = std::round(getBeatPosition(static_cast<double>(samplePos)));
+    return static_cast<int64_t>(std::llround(getSampleForBeat(beat)));
+}
+
+std::vector<double> BeatGrid::toArray() const
+{
+    std::vector<double> data;
+    if (! isValid())
+        return data;
+
+    data.reserve(1 + segments.size() * 2);
+    data.push_back(sampleRate);
+    data.push_back(segments.front().startSample);
+    data.push_back(sampleRate * 60.0 / segments.front().samplesPerBeat);
+
+    for (size_t i = 1; i < segments.size(); ++i)
+    {
+        data.push_back(segments[i].startBeat);
+        data.push_back(sampleRate * 60.0 / segments[i].samplesPerBeat);
+    }
+    return data;
+}
+
+BeatGrid BeatGrid::fromArray(const std::vector<double>& data)
+{
+    if (data.size() < 3 || (data.size() - 3) % 2 != 0)
+        return {};
+
+    BeatGrid grid(data[0], data[1], data[2]);
+    for (size_t i = 3; i + 1 < data.size(); i += 2)
+    {
+        grid.addTempoChange(static_cast<int64_t>(data[i]), data[i + 1]);
+    }
+    return grid;
+}
+
+const BeatGrid::Segment& BeatGrid::segmentForSample(double samplePos) const
+{
+    //last segment starting at or before samplePos, the first one covers everything before it
+    auto it = std::upper_bound(segments.begin(), segments.end(), samplePos,
+        [](double pos, const Segment& segment) { return pos < segment.startSample; });
+
+    return it == segments.begin() ? segments.front() : *(it - 1);
+}
+
+const BeatGrid::Segment& BeatGrid::segmentForBeat(double beat) const
+{
+    auto it = std::upper_bound(segments.begin(), segments.end(), beat,
+        [](double b, const Segment& segment) { return b < segment.startBeat; });
+
+    return it == segments.begin() ? segments.front() : *(it - 1);
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    BeatGrid.h
+    Created: 19 Oct 2026 9:41:05am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/** Beat grid of a track: the first beat and its tempo, plus optional tempo
+    changes that always start on a beat. Positions are in samples of the
+    source file, so the grid does not depend on the playback speed.
+
+    Beats are numbered continuously from the first beat (beat 0), which makes
+    every lookup a binary search over the segments plus some arithmetic. **/
+class BeatGrid
+{
+    public:
+        BeatGrid() = default;
+
+        /** Constant tempo grid starting at firstBeatSample **/
+        BeatGrid(double sampleRate, double firstBeatSample, double bpm);
+
+        /** Start a new tempo segment at the given beat. Beats must be added
+        in increasing order and after the first beat **/
+        void addTempoChange(int64_t beatIndex, double bpm);
+
+        bool isValid() const { return sampleRate > 0.0 && ! segments.empty(); }
+
+        double getSampleRate() const { return sampleRate; }
+
+        /** Tempo at the given sample position **/
+        double getBpmAt(int64_t samplePos) const;
+
+        /** Length of one beat in samples at the given sample position **/
+        double getSamplesPerBeatAt(int64_t samplePos) const;
+
+        /** Continuous beat number at the given sample position, e.g. 4.5 is
+        half way between the fifth and the sixth beat **/
+        double getBeatPosition(double samplePos) const;
+
+        /** Exact sample position of a (possibly fractional) beat number **/
+        double getSampleForBeat(double beat) const;
+
+        /** First beat strictly after samplePos, -1 if the grid is empty **/
+        int64_t getNextBeatAfter(int64_t samplePos) const;
+
+        /** Beat at or before samplePos, -1 if the grid is empty **/
+        int64_t getBeatAtOrBefore(int64_t samplePos) const;
+
+        /** Closest beat to samplePos, -1 if the grid is empty **/
+        int64_t getNearestBeat(int64_t samplePos) const;
+
+        /** Compact form for storing with the track:
+        [sampleRate, firstBeatSample, bpm, (beatIndex, bpm)...] **/
+        std::vector<double> toArray() const;
+
+        /** Rebuild a grid from toArray(), returns an empty grid on bad data **/
+        static BeatGrid fromArray(const std::vector<double>& data);
+
+        /** Stored instead of toArray() for a track analysed without finding a
+        beat, so it isn't analysed again. fromArray gives an empty grid for it **/
+        static std::vector<double> noGridFound() { return { 0.0 }; }
+
+    private:
+        struct Segment
+        {
+            double startBeat;       // beat number the segment starts on
+            double startSample;     // exact sample position of startBeat
+            double samplesPerBeat;
+        };
+
+        const Segment& segmentForSample(double samplePos) const;
+        const Segment& segmentForBeat(double beat) const;
+
+        double sampleRate = 0.0;
+        std::vector<Segment> segments;
+};
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    CachedTrackSource.cpp
+    Created: 19 Oct 2026 4:58:30pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CachedTrackSource.h"
+
+CachedTrackSource::CachedTrackSource(DecodedBlockCache& _cache, DecodedBlockCache::TrackPtr _track,
+                                     AudioFormatReader* fallbackReader)
+    : cache(_cache),
+      track(std::move(_track)),
+      cursor(cache.addCursor(track)),
+      fallback(fallbackReader, true)
+{
+}
+
+void CachedTrackSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    fallback.prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void CachedTrackSource::releaseResources()
+{
+    fallback.releaseResources();
+}
+
+void CachedTrackSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    int64 pos = position;
+
+    if (!cache.readFromAudioThread(*track, pos, *bufferToFill.buffer,
+                                   bufferToFill.startSample, bufferToFill.numSamples))
+    {
+        //the file only seeks when playback jumped since the last miss
+        if (fallback.getNextReadPosition() != pos)
+            fallback.setNextReadPosition(pos);
+
+        fallback.getNextAudioBlock(bufferToFill);
+    }
+
+    position = pos + bufferToFill.numSamples;
+    cursor->position = position.load();
+}
+
+void CachedTrackSource::setNextReadPosition(int64 newPosition)
+{
+    position = newPosition;
+    cursor->position = newPosition;
+}
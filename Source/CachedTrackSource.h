@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    CachedTrackSource.h
+    Created: 19 Oct 2026 4:58:30pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DecodedBlockCache.h"
+#include <atomic>
+#include <memory>
+
+/** Plays a track out of the DecodedBlockCache. The cache decodes ahead of the
+    playhead in the background, a block that isn't there yet is read from the
+    file like an AudioFormatReaderSource would. **/
+class CachedTrackSource : public PositionableAudioSource
+{
+public:
+    /** fallbackReader reads what the cache misses and is owned from here on **/
+    CachedTrackSource(DecodedBlockCache& cache, DecodedBlockCache::TrackPtr track,
+                      AudioFormatReader* fallbackReader);
+    ~CachedTrackSource() override = default;
+
+    double getSampleRate() const { return track->getSampleRate(); }
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(int64 newPosition) override;
+    int64 getNextReadPosition() const override { return position.load(); }
+    int64 getTotalLength() const override { return track->getLengthInSamples(); }
+    bool isLooping() const override { return false; }
+
+private:
+    DecodedBlockCache& cache;
+    DecodedBlockCache::TrackPtr track;
+    DecodedBlockCache::CursorPtr cursor;
+    AudioFormatReaderSource fallback;
+
+    std::atomic<int64> position{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedTrackSource)
+};
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    ContentHash.cpp
+    Created: 19 Oct 2026 11:48:20pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ContentHash.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int64 edgeBytes = 65536;
+    constexpr int numChunks = 16;
+    constexpr int64 chunkBytes = 4096;
+
+    constexpr uint64_t prime1 = 11400714785074694791ULL;
+    constexpr uint64_t prime2 = 14029467366897019727ULL;
+    constexpr uint64_t prime3 = 1609587929392839161ULL;
+    constexpr uint64_t prime4 = 9650029242287828579ULL;
+    constexpr uint64_t prime5 = 2870177450012600261ULL;
+
+    uint64_t rotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    //little endian whatever the machine, so fingerprints match across platforms
+    uint64_t read64(const uint8_t* p)
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+            value = (value << 8) | p[i];
+        return value;
+    }
+
+    uint32_t read32(const uint8_t* p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+             | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * prime2;
+        accumulator = rotateLeft(accumulator, 31);
+        return accumulator * prime1;
+    }
+
+    uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= round(0, value);
+        return accumulator * prime1 + prime4;
+    }
+}
+
+uint64 ContentHash::ofFile(const File& file)
+{
+    FileInputStream input(file);
+    if (input.failedToOpen())
+        return 0;
+
+    const int64 size = input.getTotalLength();
+
+    //the size goes first, two files with the same samples but different lengths differ
+    std::vector<uint8_t> sampled(sizeof(int64));
+    for (size_t i = 0; i < sizeof(int64); ++i)
+        sampled[i] = static_cast<uint8_t>(static_cast<uint64_t>(size) >> (8 * i));
+
+    auto readAt = [&](int64 position, int64 numBytes)
+    {
+        numBytes = jmin(numBytes, size - position);
+        if (numBytes <= 0 || !input.setPosition(position))
+            return;
+
+        size_t start = sampled.size();
+        sampled.resize(start + static_cast<size_t>(numBytes));
+        int numRead = input.read(sampled.data() + start, static_cast<int>(numBytes));
+        sampled.resize(start + static_cast<size_t>(jmax(0, numRead)));
+    };
+
+    if (size <= edgeBytes * 2 + numChunks * chunkBytes)
+    {
+        readAt(0, size);
+    }
+    else
+    {
+        readAt(0, edgeBytes);
+        int64 spacing = (size - edgeBytes * 2) / numChunks;
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+            readAt(edgeBytes + chunk * spacing + (spacing - chunkBytes) / 2, chunkBytes);
+        readAt(size - edgeBytes, edgeBytes);
+    }
+
+    uint64 hash = xxHash64(sampled.data(), sampled.size());
+    //0 means not hashed in the library
+    return hash != 0 ? hash : 1;
+}
+
+uint64 ContentHash::xxHash64(const void* data, size_t length, uint64 seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + length;
+    uint64_t hash;
+
+    if (length >= 32)
+    {
+        uint64_t v1 = seed + prime1 + prime2;
+        uint64_t v2 = seed + prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - prime1;
+
+        for (; p + 32 <= end; p += 32)
+        {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+        }
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = mergeRound(hash, v1);
+        hash = mergeRound(hash, v2);
+        hash = mergeRound(hash, v3);
+        hash = mergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + prime5;
+    }
+
+    hash += length;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        hash ^= round(0, read64(p));
+        hash = rotateLeft(hash, 27) * prime1 + prime4;
+    }
+
+    if (p + 4 <= end)
+    {
+        hash ^= static_cast<uint64_t>(read32(p)) * prime1;
+        hash = rotateLeft(hash, 23) * prime2 + prime3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        hash ^= *p * prime5;
+        hash = rotateLeft(hash, 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::string ContentHash::toString(uint64 hash)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i)
+    {
+        text[static_cast<size_t>(i)] = digits[hash & 0xf];
+        hash >>= 4;
+    }
+    return text;
+}
+
+uint64 ContentHash::fromString(const std::string& text)
+{
+    uint64 hash = 0;
+    for (char c : text)
+    {
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0)
+            return 0;
+        hash = (hash << 4) | static_cast<uint64>(digit);
+    }
+    return hash;
+}
@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    ContentHash.h
+    Created: 19 Oct 2026 11:48:20pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** Identity of a track from what is in the file rather than where it is.
+
+    The fingerprint is xxHash64 over the file size, the first and the last
+    64 kB and sixteen 4 kB chunks spread evenly in between, so it costs about
+    200 kB of reading whatever the size of the file. A moved or renamed file
+    keeps its fingerprint, a re-encoded or edited one gets a new one. **/
+class ContentHash
+{
+public:
+    /** Fingerprint of the file, 0 when it can't be read **/
+    static uint64 ofFile(const File& file);
+
+    /** xxHash64 of a block of memory **/
+    static uint64 xxHash64(const void* data, size_t length, uint64 seed = 0);
+
+    /** Fixed width lower case hex, the form used as a library key **/
+    static std::string toString(uint64 hash);
+    static uint64 fromString(const std::string& text);
+};
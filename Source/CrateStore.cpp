@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    CrateStore.cpp
+    Created: 20 Oct 2026 2:41:10am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CrateStore.h"
+#include "../Thirdparty/nlohmann/json.hpp"
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+namespace
+{
+    //changes made together, a whole selection put in a crate, are one write
+    constexpr int saveDelayMs = 1000;
+}
+
+CrateStore::CrateStore(const TrackTable& _table)
+    : table(_table)
+{
+}
+
+CrateStore::~CrateStore()
+{
+    //a change still waiting to be written
+    if (isTimerRunning())
+    {
+        stopTimer();
+        save();
+    }
+}
+
+void CrateStore::open(const File& _file)
+{
+    file = _file;
+    crates.clear();
+    resolved = false;
+
+    if (!file.existsAsFile())
+        return;
+
+    std::ifstream input(file.getFullPathName().toStdString());
+    try
+    {
+        nlohmann::json stored = nlohmann::json::parse(input);
+        for (const auto& entry : stored.at("crates"))
+        {
+            Crate crate;
+            crate.name = String(entry.at("name").get<std::string>());
+            crate.keys = entry.at("tracks").get<std::vector<std::string>>();
+            crates.push_back(std::move(crate));
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        std::cout << "CrateStore::open - can't read " << file.getFullPathName() << ": " << e.what() << std::endl;
+    }
+}
+
+void CrateStore::resolve()
+{
+    for (auto& crate : crates)
+    {
+        crate.ids.clear();
+        crate.ids.reserve(crate.keys.size());
+        for (const auto& key : crate.keys)
+        {
+            TrackId id = table.findTrack(key);
+            if (id >= 0)
+                crate.ids.push_back(id);
+        }
+        crate.keys = {};
+    }
+
+    resolved = true;
+    purgeNeeded = false;
+}
+
+//==============================================================================
+const std::vector<CrateStore::TrackId>& CrateStore::getTracks(int crate) const
+{
+    purge();
+    return crates[static_cast<size_t>(crate)].ids;
+}
+
+bool CrateStore::contains(int crate, TrackId id) const
+{
+    const auto& ids = getTracks(crate);
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+int CrateStore::addCrate(const String& name)
+{
+    Crate crate;
+    crate.name = name;
+    crates.push_back(std::move(crate));
+    changed();
+    return getNumCrates() - 1;
+}
+
+void CrateStore::removeCrate(int crate)
+{
+    crates.erase(crates.begin() + crate);
+    changed();
+}
+
+void CrateStore::addTracks(int crate, const std::vector<TrackId>& ids)
+{
+    //the tracks put in a crate come from the library, so it has to be loaded
+    jassert(resolved);
+
+    auto& crateIds = crates[static_cast<size_t>(crate)].ids;
+    std::unordered_set<TrackId> present(crateIds.begin(), crateIds.end());
+    for (TrackId id : ids)
+    {
+        if (table.contains(id) && present.insert(id).second)
+            crateIds.push_back(id);
+    }
+    changed();
+}
+
+void CrateStore::removeTracks(int crate, const std::vector<TrackId>& ids)
+{
+    std::unordered_set<TrackId> removed(ids.begin(), ids.end());
+    auto& crateIds = crates[static_cast<size_t>(crate)].ids;
+    crateIds.erase(std::remove_if(crateIds.begin(), crateIds.end(),
+                                  [&removed](TrackId id) { return removed.count(id) != 0; }),
+                   crateIds.end());
+    changed();
+}
+
+void CrateStore::tracksRemoved()
+{
+    if (!resolved)
+        return;
+
+    purgeNeeded = true;
+    changed();
+}
+
+void CrateStore::purge() const
+{
+    if (!purgeNeeded)
+        return;
+
+    for (auto& crate : crates)
+    {
+        crate.ids.erase(std::remove_if(crate.ids.begin(), crate.ids.end(),
+                                       [this](TrackId id) { return !table.contains(id); }),
+                        crate.ids.end());
+    }
+    purgeNeeded = false;
+}
+
+//==============================================================================
+void CrateStore::changed()
+{
+    startTimer(saveDelayMs);
+}
+
+void CrateStore::timerCallback()
+{
+    stopTimer();
+    save();
+}
+
+void CrateStore::save()
+{
+    //crates read but not resolved still only have their keys, nothing to write
+    if (!resolved || file == File())
+        return;
+
+    purge();
+
+    nlohmann::json stored = { { "crates", nlohmann::json::array() } };
+    for (const auto& crate : crates)
+    {
+        nlohmann::json tracks = nlohmann::json::array();
+        for (TrackId id : crate.ids)
+            tracks.push_back(table.getKey(id));
+        stored["crates"].push_back({ { "name", crate.name.toStdString() }, { "tracks", std::move(tracks) } });
+    }
+
+    TemporaryFile temp(file);
+    if (!temp.getFile().replaceWithText(stored.dump(4)) || !temp.overwriteTargetFileWithTemporary())
+        std::cout << "CrateStore::save - can't write " << file.getFullPathName() << std::endl;
+}
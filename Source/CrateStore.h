@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    CrateStore.h
+    Created: 20 Oct 2026 2:41:10am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <string>
+#include <vector>
+#include "TrackTable.h"
+
+/** Named crates of tracks from the library. A crate is only an array of
+    track ids in the order they were put in it; the tracks, with their
+    analysis and tags, are stored once in the TrackTable however many crates
+    hold them.
+
+    Ids only last a session, so crates.json holds the tracks' keys. They are
+    turned into ids once the library has loaded, and the file is written
+    again a second after the last change. **/
+class CrateStore : private Timer
+{
+public:
+    using TrackId = TrackTable::TrackId;
+
+    explicit CrateStore(const TrackTable& table);
+    ~CrateStore() override;
+
+    /** Read the crates in file, their tracks are found by resolve **/
+    void open(const File& file);
+
+    /** Find the tracks of the crates read by their keys, once the table holds
+    the whole library. Tracks no longer in it are dropped **/
+    void resolve();
+
+    int getNumCrates() const { return static_cast<int>(crates.size()); }
+    const String& getName(int crate) const { return crates[static_cast<size_t>(crate)].name; }
+
+    /** Ids of the crate's tracks, in its order. Tracks removed from the
+    library are left out **/
+    const std::vector<TrackId>& getTracks(int crate) const;
+
+    bool contains(int crate, TrackId id) const;
+
+    /** Add an empty crate at the end, returns its index **/
+    int addCrate(const String& name);
+    void removeCrate(int crate);
+
+    /** Append the tracks not in the crate yet, in order **/
+    void addTracks(int crate, const std::vector<TrackId>& ids);
+    void removeTracks(int crate, const std::vector<TrackId>& ids);
+
+    /** Tracks were removed from the library, they leave every crate the next
+    time one is read **/
+    void tracksRemoved();
+
+    /** The key of a track changed, the file is written again with it **/
+    void keysChanged() { changed(); }
+
+private:
+    struct Crate
+    {
+        String name;
+        std::vector<TrackId> ids;
+        std::vector<std::string> keys;  // read from the file, until resolved
+    };
+
+    void timerCallback() override;
+
+    /** Write the file a second from now **/
+    void changed();
+    void save();
+
+    /** Drop the tracks removed from the library from every crate **/
+    void purge() const;
+
+    const TrackTable& table;
+    File file;
+
+    //purged when read, removing tracks from the library costs nothing until then
+    mutable std::vector<Crate> crates;
+    mutable bool purgeNeeded = false;
+
+    bool resolved = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CrateStore)
+};
@@ -9,16 +9,23 @@ Author:  matthew
 */
 
 #include "DJAudioPlayer.h"
+#include "ContentHash.h"
 
-DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager) 
-: formatManager(_formatManager)
+namespace
 {
+    //tempo assumed for beat loops on tracks without a grid
+    constexpr double defaultBpm = 120.0;
+}
 
+DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager, DecodedBlockCache& _blockCache) 
+: formatManager(_formatManager), blockCache(_blockCache)
+{
+    hotCues.fill(-1);
 }
 
 DJAudioPlayer::~DJAudioPlayer()
 {
-
+    loopPool.removeAllJobs(true, 4000);
 }
 
 void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate) 
@@ -32,24 +39,27 @@ void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRat
     //initialize low pass filter
     lowPassFilter.prepare(spec);
     lowPassFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    lowPassFilter.setCutoffFrequency(150.0f);
+    lowPassFilter.setCutoffFrequency(lowCutoffHz);
     lowPassFilter.reset();
 
 	//initialize mid band filter
 	midBandFilter.prepare(spec);
 	midBandFilter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-	midBandFilter.setCutoffFrequency(1000.0f);
+	midBandFilter.setCutoffFrequency(midCentreHz);
 	midBandFilter.reset();
 
 	//initialize high pass filter
 	highPassFilter.prepare(spec);
 	highPassFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-	highPassFilter.setCutoffFrequency(4000.0f);
+	highPassFilter.setCutoffFrequency(highCutoffHz);
 	highPassFilter.reset();
 
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
 
+    syncEngine.prepare(sampleRate);
+    meter.prepare(sampleRate);
+
 }
 void DJAudioPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
 {
@@ -100,7 +110,7 @@ void DJAudioPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFil
 
 
     //____________________________________________________________________
- 
+    meter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
 
 }
 void DJAudioPlayer::releaseResources()
@@ -111,20 +121,70 @@ void DJAudioPlayer::releaseResources()
 }
 
 void DJAudioPlayer::loadURL(URL audioURL)
+{
+    if (auto prepared = prepareURL(audioURL))
+        loadPrepared(std::move(prepared));
+}
+
+std::unique_ptr<PreparedTrack> DJAudioPlayer::prepareURL(URL audioURL, uint64 contentHash) const
 {
     auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
-    if (reader != nullptr) // good file!
-    {       
-        std::unique_ptr<AudioFormatReaderSource> newSource (new AudioFormatReaderSource (reader, 
-                                                                                            true)); 
-        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);             
-        readerSource.reset (newSource.release());   
+    if (reader == nullptr) // bad file!
+        return nullptr;
 
-		std::cout << "DJAudioPlayer::loadURL - sample rate: " << reader->sampleRate << std::endl;
-		std::cout << "DJAudioPlayer::loadURL - lenght in samples: " << reader->lengthInSamples << std::endl;
+    auto prepared = std::make_unique<PreparedTrack>();
+    prepared->url = audioURL;
+    prepared->sampleRate = reader->sampleRate;
+    prepared->lengthInSamples = reader->lengthInSamples;
 
+    //local files share their decoded blocks with the other deck, the waveform and the analysis
+    if (audioURL.isLocalFile())
+    {
+        prepared->track = blockCache.openTrack(audioURL.getLocalFile());
+        prepared->thumbnailHash = static_cast<int64>(contentHash != 0 ? contentHash
+                                                                      : ContentHash::ofFile(audioURL.getLocalFile()));
+    }
 
+    if (prepared->track != nullptr)
+    {
+        prepared->source.reset (new CachedTrackSource (blockCache, prepared->track, reader));
+        prepared->decodeReader.reset (new DecodedBlockReader (blockCache, prepared->track, true));
+        prepared->prefetchReader.reset (new DecodedBlockReader (blockCache, prepared->track, true));
     }
+    else
+    {
+        prepared->source.reset (new AudioFormatReaderSource (reader, true));
+        prepared->decodeReader.reset (formatManager.createReaderFor(audioURL.createInputStream(false)));
+        prepared->prefetchReader.reset (formatManager.createReaderFor(audioURL.createInputStream(false)));
+    }
+    return prepared;
+}
+
+void DJAudioPlayer::loadPrepared(std::unique_ptr<PreparedTrack> prepared)
+{
+    if (prepared == nullptr)
+        return;
+
+    //detach the transport while the loop source changes reader
+    transportSource.setSource (nullptr);
+    loopSource.setSource (prepared->source.get());
+    transportSource.setSource (&loopSource, 0, nullptr, prepared->sampleRate);
+    readerSource = std::move(prepared->source);
+    sourceSampleRate = prepared->sampleRate;
+    trackLength = prepared->lengthInSamples;
+
+    decodeReader = std::move(prepared->decodeReader);
+    prefetcher.setTrack (std::move(prepared->prefetchReader));
+    //a loop still decoding belongs to the previous track
+    ++loopSerial;
+    loopPending = false;
+
+    //the old grid and cues belong to the previous track
+    setBeatGrid({});
+    hotCues.fill(-1);
+
+    std::cout << "DJAudioPlayer::loadPrepared - sample rate: " << prepared->sampleRate << std::endl;
+    std::cout << "DJAudioPlayer::loadPrepared - lenght in samples: " << prepared->lengthInSamples << std::endl;
 }
 
 void DJAudioPlayer::setGain(double gain)
@@ -178,12 +238,26 @@ void DJAudioPlayer::setSpeed(double ratio)
         std::cout << "DJAudioPlayer::setSpeed ratio should be between 0 and 100" << std::endl;
     }
     else {
-        resampleSource.setResamplingRatio(ratio);
+        userSpeed = ratio;
+        //while synced the speed is driven by the leader deck
+        if (!syncEnabled)
+        {
+            playbackSpeed = ratio;
+            resampleSource.setResamplingRatio(ratio);
+        }
     }
 }
 void DJAudioPlayer::setPosition(double posInSecs)
 {
-    transportSource.setPosition(posInSecs);
+    if (readerSource == nullptr)
+        return;
+
+    //a prefetched window turns the seek into a pointer swap on the audio thread
+    int64 samplePos = static_cast<int64>(posInSecs * sourceSampleRate);
+    if (auto window = prefetcher.findWindow(samplePos))
+        loopSource.jumpTo(window, samplePos);
+    else
+        transportSource.setPosition(posInSecs);
 }
 
 void DJAudioPlayer::setPositionRelative(double pos)
@@ -216,4 +290,223 @@ double DJAudioPlayer::getPositionRelative()
 void DJAudioPlayer::toggleEQ()
 {
 	onOffEQ = !onOffEQ;
-}
\ No newline at end of file
+}
+
+void DJAudioPlayer::prefetchAround(double pos)
+{
+    if (readerSource == nullptr)
+        return;
+
+    if (pos < 0 || pos > 1.0)
+        prefetcher.setHoverTarget(-1);
+    else
+        prefetcher.setHoverTarget(static_cast<int64>(pos * loopSource.getTotalLength()));
+}
+
+void DJAudioPlayer::setBeatGrid(const BeatGrid& grid)
+{
+    std::shared_ptr<const BeatGrid> newGrid;
+    if (grid.isValid())
+        newGrid = std::make_shared<const BeatGrid>(grid);
+
+    {
+        const SpinLock::ScopedLockType lock(beatGridLock);
+        std::swap(beatGrid, newGrid);
+    }
+    //the old grid is released here, outside the lock
+}
+
+int64 DJAudioPlayer::getCurrentSample()
+{
+    if (readerSource == nullptr)
+        return 0;
+
+    //the loop source knows the playhead, the reader stands still while looping
+    return loopSource.getNextReadPosition();
+}
+
+int64 DJAudioPlayer::getNextBeatAfter(int64 samplePos)
+{
+    const SpinLock::ScopedLockType lock(beatGridLock);
+    if (beatGrid == nullptr)
+        return -1;
+
+    return beatGrid->getNextBeatAfter(samplePos);
+}
+
+void DJAudioPlayer::setSyncEnabled(bool shouldSync)
+{
+    if (shouldSync)
+    {
+        syncNeedsReset = true;
+        syncEnabled = true;
+    }
+    else
+    {
+        syncEnabled = false;
+        //back to the user's speed
+        playbackSpeed = userSpeed.load();
+        resampleSource.setResamplingRatio(userSpeed);
+    }
+}
+
+DeckState DJAudioPlayer::getDeckState() const
+{
+    DeckState state;
+    state.position = loopSource.getNextReadPosition();
+    state.length = trackLength;
+    state.playing = transportSource.isPlaying();
+    state.levels = meter.getLevels();
+    return state;
+}
+
+DeckTiming DJAudioPlayer::getTiming()
+{
+    DeckTiming timing;
+    timing.playing = transportSource.isPlaying();
+    timing.speed = playbackSpeed;
+
+    //never wait on the message thread, a skipped block just keeps the last ratio
+    const SpinLock::ScopedTryLockType lock(beatGridLock);
+    if (lock.isLocked() && beatGrid != nullptr && readerSource != nullptr)
+    {
+        int64 samplePos = loopSource.getNextReadPosition();
+        timing.hasGrid = true;
+        timing.beatPosition = beatGrid->getBeatPosition(static_cast<double>(samplePos));
+        timing.bpm = beatGrid->getBpmAt(samplePos);
+    }
+    return timing;
+}
+
+void DJAudioPlayer::followTempo(DJAudioPlayer& leader, int numSamples)
+{
+    if (!syncEnabled)
+    {
+        //catches a sync ratio written while sync was being switched off
+        double speed = userSpeed;
+        if (playbackSpeed != speed)
+        {
+            playbackSpeed = speed;
+            resampleSource.setResamplingRatio(speed);
+        }
+        return;
+    }
+
+    if (syncNeedsReset.exchange(false))
+        syncEngine.reset();
+
+    DeckTiming leaderTiming = leader.getTiming();
+    DeckTiming timing = getTiming();
+    if (!timing.hasGrid)
+        return;
+
+    double ratio = syncEngine.process(leaderTiming, timing, numSamples);
+    if (ratio != timing.speed)
+    {
+        playbackSpeed = ratio;
+        resampleSource.setResamplingRatio(ratio);
+    }
+}
+
+void DJAudioPlayer::setHotCue(int slot)
+{
+    if (!isPositiveAndBelow(slot, numHotCues) || decodeReader == nullptr)
+        return;
+
+    int64 cue = getCurrentSample();
+    {
+        const SpinLock::ScopedLockType lock(beatGridLock);
+        if (beatGrid != nullptr)
+            cue = jmax<int64>(0, beatGrid->getNearestBeat(cue));
+    }
+
+    hotCues[slot] = cue;
+    prefetcher.setCueTargets({ hotCues.begin(), hotCues.end() });
+}
+
+void DJAudioPlayer::clearHotCue(int slot)
+{
+    if (!isPositiveAndBelow(slot, numHotCues))
+        return;
+
+    hotCues[slot] = -1;
+    prefetcher.setCueTargets({ hotCues.begin(), hotCues.end() });
+}
+
+bool DJAudioPlayer::hasHotCue(int slot) const
+{
+    return isPositiveAndBelow(slot, numHotCues) && hotCues[slot] >= 0;
+}
+
+void DJAudioPlayer::jumpToHotCue(int slot)
+{
+    if (!hasHotCue(slot))
+        return;
+
+    //right after setting the cue the window may still be decoding
+    if (auto window = prefetcher.findWindow(hotCues[slot]))
+        loopSource.jumpTo(window, hotCues[slot]);
+    else
+        loopSource.setNextReadPosition(hotCues[slot]);
+}
+
+void DJAudioPlayer::setBeatLoop(double numBeats)
+{
+    if (numBeats <= 0 || decodeReader == nullptr)
+        return;
+
+    int64 playhead = getCurrentSample();
+    int64 loopStart = playhead;
+    int64 loopEnd = playhead + static_cast<int64>(numBeats * decodeReader->sampleRate * 60.0 / defaultBpm);
+    {
+        //loop from the beat at or before the playhead so it starts on the grid
+        const SpinLock::ScopedLockType lock(beatGridLock);
+        if (beatGrid != nullptr)
+        {
+            double startBeat = std::floor(beatGrid->getBeatPosition(static_cast<double>(playhead)));
+            loopStart = jmax<int64>(0, std::llround(beatGrid->getSampleForBeat(startBeat)));
+            loopEnd = std::llround(beatGrid->getSampleForBeat(startBeat + numBeats));
+        }
+    }
+
+    //the loop needs a little past its end for the wrap crossfade, or the end of the track
+    int64 windowEnd = jmin(loopEnd + LoopingAudioSource::crossfadeLength, trackLength.load());
+    int serial = ++loopSerial;
+
+    //the prefetcher usually holds the audio around the playhead already
+    if (auto window = prefetcher.findWindow(loopStart))
+    {
+        if (window->getEndSample() >= windowEnd)
+        {
+            loopPending = false;
+            loopSource.setLoop(window, loopStart, jmin(loopEnd, window->getEndSample()));
+            return;
+        }
+    }
+
+    loopPending = true;
+    loopPool.removeAllJobs(false, 0);
+    loopPool.addJob([reader = decodeReader, serial, loopStart, loopEnd, windowEnd,
+                     weakThis = WeakReference<DJAudioPlayer>(this)]
+    {
+        auto window = DecodedWindow::decode(*reader, loopStart, windowEnd - loopStart);
+
+        MessageManager::callAsync([weakThis, serial, window, loopStart, loopEnd]
+        {
+            //exited, set again or another track loaded since
+            if (weakThis == nullptr || serial != weakThis->loopSerial)
+                return;
+
+            weakThis->loopPending = false;
+            if (window != nullptr)
+                weakThis->loopSource.setLoop(window, loopStart, jmin(loopEnd, window->getEndSample()));
+        });
+    });
+}
+
+void DJAudioPlayer::exitLoop()
+{
+    ++loopSerial;
+    loopPending = false;
+    loopSource.clearLoop();
+}
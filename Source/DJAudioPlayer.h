@@ -11,12 +11,52 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "BeatGrid.h"
+#include "SyncEngine.h"
+#include "LoopingAudioSource.h"
+#include "SeekPrefetcher.h"
+#include "DecodedBlockCache.h"
+#include "CachedTrackSource.h"
+#include "LevelMeter.h"
+#include <array>
 //#include <juce_dsp/juce_dsp.h>
 
+/** Everything loadURL opens for a track: the readers and the shared block
+    cache track. Built by prepareURL, on any thread **/
+struct PreparedTrack
+{
+    URL url;
+    std::unique_ptr<PositionableAudioSource> source;
+    double sampleRate = 0.0;
+    int64 lengthInSamples = 0;
+    //nullptr for streams, they are read straight from the reader
+    DecodedBlockCache::TrackPtr track;
+    std::unique_ptr<AudioFormatReader> decodeReader;
+    std::unique_ptr<AudioFormatReader> prefetchReader;
+    //content of a local file, the waveform is cached by it
+    int64 thumbnailHash = 0;
+};
+
+/** What the GUI shows of a deck, published by the audio thread once per block */
+struct DeckState
+{
+    //in samples of the loaded file
+    int64 position = 0;
+    int64 length = 0;
+    bool playing = false;
+    //the deck's output, after the EQ and the volume
+    MeterLevels levels;
+};
+
 class DJAudioPlayer : public AudioSource {
   public:
 
-    DJAudioPlayer(AudioFormatManager& _formatManager);
+    /** where the EQ splits the three bands, the waveform colours follow the same split */
+    static constexpr float lowCutoffHz = 150.0f;
+    static constexpr float midCentreHz = 1000.0f;
+    static constexpr float highCutoffHz = 4000.0f;
+
+    DJAudioPlayer(AudioFormatManager& _formatManager, DecodedBlockCache& _blockCache);
     ~DJAudioPlayer();
 
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
@@ -24,6 +64,20 @@ class DJAudioPlayer : public AudioSource {
     void releaseResources() override;
 
     void loadURL(URL audioURL);
+
+    /** open the file and its readers without touching what is playing, nullptr when
+        it can't be read. Blocking on the file, call it off the message thread ahead of time.
+        A local file is fingerprinted for its waveform unless contentHash, as stored by the
+        library, is given */
+    std::unique_ptr<PreparedTrack> prepareURL(URL audioURL, uint64 contentHash = 0) const;
+
+    /** swap to a track opened by prepareURL, nothing here waits on the file */
+    void loadPrepared(std::unique_ptr<PreparedTrack> prepared);
+
+    bool isPlaying() const { return transportSource.isPlaying(); }
+    double getLengthInSeconds() const { return transportSource.getLengthInSeconds(); }
+    double getGain() const { return transportSource.getGain(); }
+
     void setGain(double gain);
     void setLowGain(double lowGain);
     void setMidGain(double midGain);
@@ -32,6 +86,10 @@ class DJAudioPlayer : public AudioSource {
     void setPosition(double posInSecs);
     void setPositionRelative(double pos);
 	void toggleEQ();
+
+    /** keep the audio around a relative position decoded, it is where the next click
+        on the waveform is likely to land. A negative position forgets the last one */
+    void prefetchAround(double pos);
     
 
     void start();
@@ -40,9 +98,56 @@ class DJAudioPlayer : public AudioSource {
     /** get the relative position of the playhead */
     double getPositionRelative();
 
+    /** set the beat grid of the loaded track, computed offline by TrackAnalyser */
+    void setBeatGrid(const BeatGrid& grid);
+
+    /** get the position of the playhead in samples of the loaded file */
+    int64 getCurrentSample();
+
+    /** get the first beat after samplePos in samples of the loaded file, -1 without a grid */
+    int64 getNextBeatAfter(int64 samplePos);
+
+    /** lock tempo and phase to another deck while enabled */
+    void setSyncEnabled(bool shouldSync);
+    bool isSyncEnabled() const { return syncEnabled.load(); }
+
+    /** get playhead, length and transport state for the GUI. Called on the audio thread */
+    DeckState getDeckState() const;
+
+    /** get beat position, tempo and speed at the playhead. Called on the audio thread */
+    DeckTiming getTiming();
+
+    /** adjust the speed for the next block so this deck stays on the leader's beat.
+        Called on the audio thread before either deck renders the block */
+    void followTempo(DJAudioPlayer& leader, int numSamples);
+
+    static constexpr int numHotCues = 4;
+
+    /** store a hot cue at the playhead, snapped to the nearest beat when there is a grid.
+        A few seconds after the cue are kept decoded so jumping doesn't seek the reader */
+    void setHotCue(int slot);
+    void clearHotCue(int slot);
+    bool hasHotCue(int slot) const;
+    void jumpToHotCue(int slot);
+
+    /** loop numBeats from the beat at the playhead. The loop plays from a window the
+        prefetcher holds when one covers it, otherwise it is decoded into RAM in the
+        background and starts once it is ready */
+    void setBeatLoop(double numBeats);
+    void exitLoop();
+    /** true while a loop plays or is being decoded */
+    bool isLooping() const { return loopSource.isLoopActive() || loopPending; }
+
 private:
     AudioFormatManager& formatManager;
-    std::unique_ptr<AudioFormatReaderSource> readerSource;
+    DecodedBlockCache& blockCache;
+    //plays from the shared block cache for local files, straight from the reader for streams
+    std::unique_ptr<PositionableAudioSource> readerSource;
+    double sourceSampleRate = 0.0;
+    //set on the message thread with the track, read by the audio thread
+    std::atomic<int64> trackLength{ 0 };
+    LevelMeter meter;
+    LoopingAudioSource loopSource;
     AudioTransportSource transportSource; 
     ResamplingAudioSource resampleSource{&transportSource, false, 2};
 
@@ -58,6 +163,33 @@ private:
 
 	bool onOffEQ = false;
 
+    //swapped on the message thread, only read under the lock
+    SpinLock beatGridLock;
+    std::shared_ptr<const BeatGrid> beatGrid;
+
+    //speed set by the user and the one actually playing, they differ while synced
+    std::atomic<double> userSpeed{ 1.0 };
+    std::atomic<double> playbackSpeed{ 1.0 };
+    std::atomic<bool> syncEnabled{ false };
+    std::atomic<bool> syncNeedsReset{ false };
+    SyncEngine syncEngine;
+
+    //second reader of the loaded track, loops the prefetcher doesn't hold are decoded
+    //with it on loopPool so the playing reader is never moved. A decode still running
+    //keeps its copy when another track is loaded
+    std::shared_ptr<AudioFormatReader> decodeReader;
+    std::array<int64, numHotCues> hotCues;
+
+    //decodes around the cues, the playhead and the mouse with a reader of its own,
+    //seeks landing there become a window swap in loopSource
+    SeekPrefetcher prefetcher{ loopSource };
+
+    //one loop decode at a time, bumping loopSerial drops one that isn't wanted any more
+    ThreadPool loopPool{ 1 };
+    int loopSerial = 0;
+    bool loopPending = false;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (DJAudioPlayer)
 };
 
 
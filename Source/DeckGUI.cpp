@@ -14,9 +14,14 @@
 //==============================================================================
 DeckGUI::DeckGUI(DJAudioPlayer* _player, 
                 AudioFormatManager & 	formatManagerToUse,
-                AudioThumbnailCache & 	cacheToUse
+                AudioThumbnailCache & 	cacheToUse,
+                DecodedBlockCache & 	blockCacheToUse,
+                WaveformCache & 	waveformCacheToUse,
+                TrackAnalyser & 	trackAnalyserToUse
            ) : player(_player), 
-               waveformDisplay(formatManagerToUse, cacheToUse)
+               waveformDisplay(formatManagerToUse, cacheToUse, blockCacheToUse),
+               zoomedWaveform(waveformCacheToUse),
+               trackAnalyser(trackAnalyserToUse)
 {
     // Set slider colors
     auto setSliderColors = [](juce::Slider& slider) {
@@ -36,11 +41,33 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     setSliderColors(midGainSlider);
     setSliderColors(highGainSlider);
 
+    for (auto* slider : { &volSlider, &speedSlider, &lowGainSlider, &midGainSlider, &highGainSlider })
+        slider->setLookAndFeel(&sliderLookAndFeel);
+
 	//Add buttons and sliders to the GUI
 	addAndMakeVisible(playButton);
 	addAndMakeVisible(stopButton);
 	addAndMakeVisible(loadButton);
 	addAndMakeVisible(eqButton);
+	addAndMakeVisible(syncButton);
+
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        hotCueButtons[i].setButtonText("CUE " + String(i + 1));
+        hotCueButtons[i].setColour(TextButton::buttonColourId, Colours::purple.withAlpha(0.15f));
+        hotCueButtons[i].setColour(TextButton::buttonOnColourId, Colours::purple.withAlpha(0.7f));
+        hotCueButtons[i].addListener(this);
+        addAndMakeVisible(hotCueButtons[i]);
+    }
+
+    for (int i = 0; i < numLoopButtons; ++i)
+    {
+        loopButtons[i].setButtonText("LOOP " + String(static_cast<int>(loopBeats[i])));
+        loopButtons[i].setColour(TextButton::buttonColourId, Colours::orange.withAlpha(0.1f));
+        loopButtons[i].setColour(TextButton::buttonOnColourId, Colours::orange.withAlpha(0.6f));
+        loopButtons[i].addListener(this);
+        addAndMakeVisible(loopButtons[i]);
+    }
 
     // Initialize labels
     addAndMakeVisible(volLabel);
@@ -70,9 +97,12 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
 	addAndMakeVisible(highGainSlider);
 
     addAndMakeVisible(waveformDisplay);
+    addAndMakeVisible(zoomedWaveform);
+    addAndMakeVisible(levelMeter);
 
     // Set the EQ button to toggle its state
     eqButton.setClickingTogglesState(true);
+    syncButton.setClickingTogglesState(true);
 
     // Set default colors for buttons
     playButton.setColour(TextButton::buttonColourId, Colours::green.withAlpha(0.2f));
@@ -83,12 +113,15 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     eqButton.setColour(TextButton::buttonColourId, juce::Colour(0xFF1DB954).withAlpha(0.06f));
     eqButton.setColour(TextButton::buttonOnColourId, juce::Colour(0xFF1DB954).withAlpha(0.6f));
     loadButton.setColour(TextButton::buttonColourId, Colours::orange.withAlpha(0.3f));
+    syncButton.setColour(TextButton::buttonColourId, Colours::skyblue.withAlpha(0.06f));
+    syncButton.setColour(TextButton::buttonOnColourId, Colours::skyblue.withAlpha(0.6f));
 
 	//Add listeners to buttons and sliders
     playButton.addListener(this);
     stopButton.addListener(this);
     loadButton.addListener(this);
 	eqButton.addListener(this);
+	syncButton.addListener(this);
 	waveformDisplay.addMouseListener(this, false);
 
     volSlider.addListener(this);
@@ -99,7 +132,9 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
 
 	//Set slider ranges
     volSlider.setRange(0.0, 1.0);
-    speedSlider.setRange(0.0, 5.0);
+    //fine steps so the speed can be matched by hand, with 1x in the middle of the slider
+    speedSlider.setRange(0.0, 5.0, 0.0001);
+    speedSlider.setSkewFactorFromMidPoint(1.0);
 	lowGainSlider.setRange(0.0, 1.0);
 	midGainSlider.setRange(0.0, 1.0);
 	highGainSlider.setRange(0.0, 1.0);
@@ -122,19 +157,19 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     highGainSlider.setTextBoxStyle(Slider::TextBoxBelow, false, 50, 20);
 
     volSlider.setNumDecimalPlacesToDisplay(2);
-    speedSlider.setNumDecimalPlacesToDisplay(2);
+    speedSlider.setNumDecimalPlacesToDisplay(4);
     lowGainSlider.setNumDecimalPlacesToDisplay(2);
     midGainSlider.setNumDecimalPlacesToDisplay(2);
     highGainSlider.setNumDecimalPlacesToDisplay(2);
 
-    startTimer(500);
-
-
 }
 
 DeckGUI::~DeckGUI()
 {
-    stopTimer();
+    preparePool.removeAllJobs(true, 4000);
+    cancelPendingUpdate();
+    for (auto* slider : { &volSlider, &speedSlider, &lowGainSlider, &midGainSlider, &highGainSlider })
+        slider->setLookAndFeel(nullptr);
 }
 
 void DeckGUI::paint (Graphics& g)
@@ -148,33 +183,43 @@ void DeckGUI::paint (Graphics& g)
 
 void DeckGUI::resized()
 {
-    double rowH = getHeight() / 8; 
-    //Set bounds for waveform display
-    waveformDisplay.setBounds(0, 0, getWidth(), rowH * 2);
+    double rowH = getHeight() / 10; 
+    //Set bounds for zoomed and overview waveform displays
+    zoomedWaveform.setBounds(0, 0, getWidth(), rowH);
+    waveformDisplay.setBounds(0, rowH, getWidth(), rowH * 2);
 
 	//Set bounds for play and stop buttons
-    playButton.setBounds(0, rowH*2, getWidth() / 3, rowH);
-    stopButton.setBounds(getWidth() / 3, rowH * 2, getWidth() / 3, rowH);
+    playButton.setBounds(0, rowH * 3, getWidth() / 3, rowH);
+    stopButton.setBounds(getWidth() / 3, rowH * 3, getWidth() / 3, rowH);
     //Set bounds for load button
-    loadButton.setBounds((getWidth() / 3) * 2, rowH * 2, getWidth() / 3, rowH);
+    loadButton.setBounds((getWidth() / 3) * 2, rowH * 3, getWidth() / 3, rowH);
+
+    //Set bounds for hot cue and loop buttons, sharing one row
+    int cueLoopWidth = getWidth() / (DJAudioPlayer::numHotCues + numLoopButtons);
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+        hotCueButtons[i].setBounds(cueLoopWidth * i, rowH * 4, cueLoopWidth, rowH);
+    for (int i = 0; i < numLoopButtons; ++i)
+        loopButtons[i].setBounds(cueLoopWidth * (DJAudioPlayer::numHotCues + i), rowH * 4, cueLoopWidth, rowH);
 
 	//Set bounds for sliders
 	int rotarySliderWidth = getWidth() / 4;
-    volSlider.setBounds(0, rowH * 3, getWidth(), rowH);
-    speedSlider.setBounds(0, rowH * 4, getWidth(), rowH);
-	lowGainSlider.setBounds(0, rowH * 5, rotarySliderWidth, rowH * 3);
-    midGainSlider.setBounds(rotarySliderWidth, rowH * 5, rotarySliderWidth, rowH * 3);
-	highGainSlider.setBounds(rotarySliderWidth * 2, rowH * 5, rotarySliderWidth, rowH * 3);
+    volSlider.setBounds(0, rowH * 5, getWidth(), rowH);
+    speedSlider.setBounds(0, rowH * 6, getWidth(), rowH);
+	lowGainSlider.setBounds(0, rowH * 7, rotarySliderWidth, rowH * 3);
+    midGainSlider.setBounds(rotarySliderWidth, rowH * 7, rotarySliderWidth, rowH * 3);
+	highGainSlider.setBounds(rotarySliderWidth * 2, rowH * 7, rotarySliderWidth, rowH * 3);
 
     // Position labels
-    volLabel.setBounds(getWidth() * 0.85, rowH * 3 - 3, getWidth(), 20);
-    speedLabel.setBounds(getWidth() * 0.85, rowH * 4 - 3, getWidth(), 20);
-    lowGainLabel.setBounds(0, rowH * 5 - 8, rotarySliderWidth, 20);
-    midGainLabel.setBounds(rotarySliderWidth, rowH * 5 - 8, rotarySliderWidth, 20);
-    highGainLabel.setBounds(rotarySliderWidth * 2, rowH * 5 - 8, rotarySliderWidth, 20);
+    volLabel.setBounds(getWidth() * 0.85, rowH * 5 - 3, getWidth(), 20);
+    speedLabel.setBounds(getWidth() * 0.85, rowH * 6 - 3, getWidth(), 20);
+    lowGainLabel.setBounds(0, rowH * 7 - 8, rotarySliderWidth, 20);
+    midGainLabel.setBounds(rotarySliderWidth, rowH * 7 - 8, rotarySliderWidth, 20);
+    highGainLabel.setBounds(rotarySliderWidth * 2, rowH * 7 - 8, rotarySliderWidth, 20);
 
-	//Set bounds for eq button
-	eqButton.setBounds(rotarySliderWidth * 3, rowH * 5 + rowH/2, rotarySliderWidth, rowH);
+	//Set bounds for eq and sync buttons, the level meter on their right
+	eqButton.setBounds(rotarySliderWidth * 3, rowH * 7 + rowH/2, rotarySliderWidth - levelMeterWidth, rowH);
+	syncButton.setBounds(rotarySliderWidth * 3, rowH * 8 + rowH * 3 / 4, rotarySliderWidth - levelMeterWidth, rowH);
+    levelMeter.setBounds(getWidth() - levelMeterWidth, rowH * 7, levelMeterWidth, rowH * 3);
 
 
 
@@ -186,16 +231,12 @@ void DeckGUI::buttonClicked(Button* button)
     if (button == &playButton)
     {
         std::cout << "Play button was clicked " << std::endl;
-        player->start();
-        playButton.setToggleState(true, dontSendNotification);
-        stopButton.setToggleState(false, dontSendNotification);
+        setPlaying(true);
     }
     if (button == &stopButton)
     {
         std::cout << "Stop button was clicked " << std::endl;
-        player->stop();
-        playButton.setToggleState(false, dontSendNotification);
-        stopButton.setToggleState(true, dontSendNotification);
+        setPlaying(false);
     }
 
 	 if (button == &eqButton)
@@ -204,6 +245,43 @@ void DeckGUI::buttonClicked(Button* button)
 		 player->toggleEQ();
 	 }
 
+    if (button == &syncButton)
+    {
+        std::cout << "Sync button was clicked " << std::endl;
+        player->setSyncEnabled(syncButton.getToggleState());
+    }
+
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        if (button == &hotCueButtons[i])
+        {
+            if (ModifierKeys::currentModifiers.isShiftDown())
+                player->clearHotCue(i);
+            else if (player->hasHotCue(i))
+                player->jumpToHotCue(i);
+            else
+                player->setHotCue(i);
+
+            hotCueButtons[i].setToggleState(player->hasHotCue(i), dontSendNotification);
+        }
+    }
+
+    for (int i = 0; i < numLoopButtons; ++i)
+    {
+        if (button == &loopButtons[i])
+        {
+            bool leaveLoop = loopButtons[i].getToggleState();
+            if (leaveLoop)
+                player->exitLoop();
+            else
+                player->setBeatLoop(loopBeats[i]);
+
+            //only the running loop is lit
+            for (int j = 0; j < numLoopButtons; ++j)
+                loopButtons[j].setToggleState(!leaveLoop && j == i && player->isLooping(), dontSendNotification);
+        }
+    }
+
     if (button == &loadButton)
     {
        auto fileChooserFlags = 
@@ -260,6 +338,24 @@ void DeckGUI::mouseDown(const MouseEvent& event)
     }
 }
 
+void DeckGUI::mouseMove(const MouseEvent& event)
+{
+    //the spot under the mouse is decoded ahead so clicking on it doesn't seek the file
+    if (event.eventComponent == &waveformDisplay)
+    {
+        double waveWidth = waveformDisplay.getWidth();
+        player->prefetchAround(event.x / waveWidth);
+    }
+}
+
+void DeckGUI::mouseExit(const MouseEvent& event)
+{
+    if (event.eventComponent == &waveformDisplay)
+    {
+        player->prefetchAround(-1.0);
+    }
+}
+
 bool DeckGUI::isInterestedInFileDrag (const StringArray &files)
 {
   std::cout << "DeckGUI::isInterestedInFileDrag" << std::endl;
@@ -271,25 +367,107 @@ void DeckGUI::filesDropped (const StringArray &files, int x, int y)
   std::cout << "DeckGUI::filesDropped" << std::endl;
   if (files.size() == 1)
   {
-    player->loadURL(URL{File{files[0]}});
+    loadURL(URL{File{files[0]}});
   }
 }
 
-void DeckGUI::timerCallback()
+void DeckGUI::refresh(const DeckState& state)
+{
+    if (state.length > 0)
+        waveformDisplay.setPositionRelative(static_cast<double>(state.position) / state.length);
+    zoomedWaveform.setPlayhead(state.position);
+    levelMeter.setLevels(state.levels);
+}
+
+void DeckGUI::setPlaying(bool shouldPlay)
 {
-    //std::cout << "DeckGUI::timerCallback" << std::endl;
-    waveformDisplay.setPositionRelative(
-            player->getPositionRelative());
+    if (shouldPlay)
+        player->start();
+    else
+        player->stop();
+    playButton.setToggleState(shouldPlay, dontSendNotification);
+    stopButton.setToggleState(!shouldPlay, dontSendNotification);
+}
+
+void DeckGUI::setVolume(double volume)
+{
+    volSlider.setValue(volume);
 }
 
-void DeckGUI::loadURL(URL audioURL)
+void DeckGUI::loadURL(URL audioURL, const BeatGrid& beatGrid, uint64 contentHash)
 {
-    player->loadURL(audioURL);
-    waveformDisplay.loadURL(audioURL);
+    PaintProfiler::Scope profile("DeckGUI::loadURL", PaintProfiler::Kind::call);
+    //opened on the pool like Auto-DJ's tracks, the deck keeps playing until it is ready
+    int serial = ++loadSerial;
+    preparePool.addJob([this, serial, audioURL, beatGrid, contentHash]
+    {
+        auto load = std::make_unique<PendingLoad>();
+        load->serial = serial;
+        load->url = audioURL;
+        load->beatGrid = beatGrid;
+        load->prepared = player->prepareURL(audioURL, contentHash);
+
+        const ScopedLock sl(pendingLock);
+        pendingLoad = std::move(load);
+        triggerAsyncUpdate();
+    });
+}
+
+void DeckGUI::handleAsyncUpdate()
+{
+    std::unique_ptr<PendingLoad> load;
+    {
+        const ScopedLock sl(pendingLock);
+        load = std::move(pendingLoad);
+    }
+    if (load == nullptr || load->serial != loadSerial)
+        return;
+
+    if (load->prepared != nullptr)
+    {
+        loadPrepared(std::move(load->prepared), load->beatGrid);
+        return;
+    }
+
+    //not readable by the player, the waveform still tries it as a stream
+    waveformDisplay.loadURL(load->url);
+    zoomedWaveform.setTrack(nullptr);
+    loadedURL = load->url;
+}
+
+void DeckGUI::loadPrepared(std::unique_ptr<PreparedTrack> prepared, const BeatGrid& beatGrid)
+{
+    PaintProfiler::Scope profile("DeckGUI::loadPrepared", PaintProfiler::Kind::call);
+    //a manual load still being opened would replace this track when it lands
+    ++loadSerial;
+    URL audioURL = prepared->url;
+    waveformDisplay.loadTrack(audioURL, prepared->track, prepared->thumbnailHash);
+    zoomedWaveform.setTrack(prepared->track);
+    player->loadPrepared(std::move(prepared));
+    loadedURL = audioURL;
+
+    if (beatGrid.isValid())
+    {
+        player->setBeatGrid(beatGrid);
+    }
+    else if (audioURL.isLocalFile())
+    {
+        trackAnalyser.analyseAsync(audioURL.getLocalFile(),
+            [safeThis = Component::SafePointer<DeckGUI>(this), audioURL](const BeatGrid& grid)
+            {
+                if (safeThis != nullptr && safeThis->loadedURL == audioURL)
+                    safeThis->player->setBeatGrid(grid);
+            });
+    }
+
     //adjust buttons toggle state
     playButton.setToggleState(false, dontSendNotification);
     stopButton.setToggleState(true, dontSendNotification);
     eqButton.setToggleState(false, dontSendNotification);
+    for (auto& cueButton : hotCueButtons)
+        cueButton.setToggleState(false, dontSendNotification);
+    for (auto& loopButton : loopButtons)
+        loopButton.setToggleState(false, dontSendNotification);
 
     //Reset slider default values
     volSlider.setValue(0.5);
@@ -13,6 +13,10 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "ZoomedWaveform.h"
+#include "LevelMeterDisplay.h"
+#include "PaintProfiler.h"
+#include "TrackAnalyser.h"
 
 //==============================================================================
 /*
@@ -22,13 +26,16 @@ class DeckGUI    : public Component,
                    public Slider::Listener, 
 	               //Added for waveform display mouse events
 	               public MouseListener,   
-                   public FileDragAndDropTarget, 
-                   public Timer
+                   public FileDragAndDropTarget,
+                   private AsyncUpdater
 {
 public:
     DeckGUI(DJAudioPlayer* player, 
            AudioFormatManager & 	formatManagerToUse,
-           AudioThumbnailCache & 	cacheToUse );
+           AudioThumbnailCache & 	cacheToUse,
+           DecodedBlockCache & 	blockCacheToUse,
+           WaveformCache & 	waveformCacheToUse,
+           TrackAnalyser & 	trackAnalyserToUse );
     ~DeckGUI();
 
     void paint (Graphics&) override;
@@ -42,14 +49,34 @@ public:
 
     /** implement mouse events **/
 	void mouseDown(const MouseEvent& event) override;
+	void mouseMove(const MouseEvent& event) override;
+	void mouseExit(const MouseEvent& event) override;
 
     bool isInterestedInFileDrag (const StringArray &files) override;
     void filesDropped (const StringArray &files, int x, int y) override; 
 
-    void timerCallback() override; 
+    /** Move the waveforms to the deck's state, called once per frame by MainComponent **/
+    void refresh(const DeckState& state);
 
-    /**Function to expose the load track function from player to allow loading from playlist**/
-	void loadURL(URL audioURL);
+    /**Function to expose the load track function from player to allow loading from playlist.
+    The file is opened on a background thread and the deck swaps to it once it is ready,
+    a later load drops this one. Without a stored beat grid the track is analysed in the
+    background, without a stored content hash the file is fingerprinted for its waveform**/
+	void loadURL(URL audioURL, const BeatGrid& beatGrid = {}, uint64 contentHash = 0);
+
+    /**Function to load a track opened ahead of time by DJAudioPlayer::prepareURL, nothing
+    waits on the file. Without a beat grid the track is analysed in the background**/
+    void loadPrepared(std::unique_ptr<PreparedTrack> prepared, const BeatGrid& beatGrid = {});
+
+    /**Function to expose the player to Auto-DJ, which prepares tracks and reads the playhead**/
+    DJAudioPlayer* getPlayer() { return player; }
+
+    /**Function to start or stop the deck as the play and stop buttons do**/
+    void setPlaying(bool shouldPlay);
+
+    /**Function to move the volume slider, the player follows it**/
+    void setVolume(double volume);
+    double getVolume() const { return volSlider.getValue(); }
 
 private:
     juce::FileChooser fChooser{"Select a file..."};
@@ -58,7 +85,17 @@ private:
     TextButton stopButton{"STOP"};
     TextButton loadButton{"LOAD"};
     TextButton eqButton{"EQ \n ON-OFF"};
+    TextButton syncButton{"SYNC"};
 
+    //hot cues: click sets the cue the first time and jumps to it after, shift-click clears it
+    TextButton hotCueButtons[DJAudioPlayer::numHotCues];
+    //beat loops, click again to leave the loop
+    static constexpr int numLoopButtons = 3;
+    const double loopBeats[numLoopButtons]{ 1.0, 4.0, 8.0 };
+    TextButton loopButtons[numLoopButtons];
+
+    //times the sliders' drawing when the profiler is on
+    ProfilingLookAndFeel sliderLookAndFeel;
   
     Slider volSlider; 
     Slider speedSlider;
@@ -67,9 +104,18 @@ private:
 	Slider highGainSlider;
 
     WaveformDisplay waveformDisplay;
+    //close-up scrolling under the playhead
+    ZoomedWaveform zoomedWaveform;
+    //the deck's output, after the EQ and the volume
+    LevelMeterDisplay levelMeter;
+    static constexpr int levelMeterWidth = 20;
 
     DJAudioPlayer* player; 
 
+    TrackAnalyser& trackAnalyser;
+    //track on the deck, a late analysis result of a previous track is dropped
+    URL loadedURL;
+
     // Labels for sliders
     juce::Label volLabel;
     juce::Label speedLabel;
@@ -77,5 +123,23 @@ private:
     juce::Label midGainLabel;
     juce::Label highGainLabel;
 
+    /** Load the track prepared by the last loadURL, on the message thread **/
+    void handleAsyncUpdate() override;
+
+    struct PendingLoad
+    {
+        int serial = 0;
+        URL url;
+        BeatGrid beatGrid;
+        std::unique_ptr<PreparedTrack> prepared;    // nullptr when the player can't read it
+    };
+
+    //files are opened here rather than on the message thread, a slow disk doesn't stall the GUI
+    ThreadPool preparePool{ 1 };
+    //bumped by every load, a prepared track that isn't the latest one is dropped
+    int loadSerial = 0;
+    CriticalSection pendingLock;
+    std::unique_ptr<PendingLoad> pendingLoad;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckGUI)
 };
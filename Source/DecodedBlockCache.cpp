@@ -0,0 +1,428 @@
+/*
+  ==============================================================================
+
+    DecodedBlockCache.cpp
+    Created: 19 Oct 2026 4:11:09pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DecodedBlockCache.h"
+
+namespace
+{
+    //two full tracks and change, both decks plus the waveforms
+    constexpr size_t defaultMemoryLimit = 256 * 1024 * 1024;
+
+    //about 6 seconds ahead of every cursor
+    constexpr int readAheadBlocks = 8;
+
+    //how long the worker sleeps when every cursor is covered
+    constexpr int idleWaitMs = 50;
+}
+
+//==============================================================================
+DecodedBlockCache::Track::Track(const File& fileToRead, std::unique_ptr<AudioFormatReader> newReader)
+    : file(fileToRead),
+      sampleRate(newReader->sampleRate),
+      lengthInSamples(newReader->lengthInSamples),
+      numChannels(jmin(2, static_cast<int>(newReader->numChannels))),
+      numBlocks(static_cast<int>((newReader->lengthInSamples + blockSize - 1) / blockSize)),
+      reader(std::move(newReader)),
+      blocks(static_cast<size_t>(numBlocks)),
+      slots(new std::atomic<const Block*>[static_cast<size_t>(numBlocks)]),
+      lastUsed(new std::atomic<uint32>[static_cast<size_t>(numBlocks)])
+{
+    for (int i = 0; i < numBlocks; ++i)
+    {
+        slots[i] = nullptr;
+        lastUsed[i] = 0;
+    }
+}
+
+DecodedBlockCache::Track::~Track()
+{
+}
+
+//==============================================================================
+DecodedBlockCache::DecodedBlockCache(AudioFormatManager& _formatManager)
+    : Thread("DecodedBlockCache"),
+      formatManager(_formatManager),
+      memoryLimit(defaultMemoryLimit)
+{
+    startThread();
+}
+
+DecodedBlockCache::~DecodedBlockCache()
+{
+    stopThread(2000);
+}
+
+DecodedBlockCache::TrackPtr DecodedBlockCache::openTrack(const File& file)
+{
+    //an edited file is a different track
+    String key = file.getFullPathName() + ":" + String(file.getLastModificationTime().toMilliseconds());
+    {
+        const ScopedLock sl(lock);
+        auto it = tracks.find(key);
+        if (it != tracks.end())
+            return it->second;
+    }
+
+    //opening can scan the whole file, keep it outside the lock
+    std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+        return nullptr;
+
+    TrackPtr track(new Track(file, std::move(reader)));
+
+    const ScopedLock sl(lock);
+    //somebody else may have opened it meanwhile
+    auto inserted = tracks.emplace(key, track);
+    return inserted.first->second;
+}
+
+std::unique_ptr<AudioFormatReader> DecodedBlockCache::createPrivateReader(const File& file)
+{
+    return std::unique_ptr<AudioFormatReader>(formatManager.createReaderFor(file));
+}
+
+DecodedBlockCache::CursorPtr DecodedBlockCache::addCursor(const TrackPtr& track)
+{
+    auto cursor = std::make_shared<Cursor>();
+    cursor->track = track;
+
+    {
+        const ScopedLock sl(lock);
+        cursors.push_back(cursor);
+    }
+    notify();
+    return cursor;
+}
+
+DecodedBlockCache::BlockPtr DecodedBlockCache::getBlock(Track& track, int blockIndex)
+{
+    if (!isPositiveAndBelow(blockIndex, track.numBlocks))
+        return nullptr;
+
+    if (auto block = findBlock(track, blockIndex))
+        return block;
+
+    //one decode per track at a time, the one who waited may find it done
+    const ScopedLock dl(track.decodeLock);
+    {
+        const ScopedLock sl(lock);
+        if (track.blocks[blockIndex] != nullptr)
+        {
+            touch(track, blockIndex);
+            return track.blocks[blockIndex];
+        }
+    }
+
+    ++misses;
+    int64 start = static_cast<int64>(blockIndex) * blockSize;
+    int numFrames = static_cast<int>(jmin<int64>(blockSize, track.lengthInSamples - start));
+
+    auto block = std::make_shared<Block>();
+    block->samples.setSize(track.numChannels, numFrames);
+    track.reader->read(&block->samples, 0, numFrames, start, true, track.numChannels > 1);
+
+    const ScopedLock sl(lock);
+    evictToLimit(getBlockBytes(*block));
+    memoryUsage += getBlockBytes(*block);
+    track.blocks[blockIndex] = block;
+    track.slots[blockIndex] = block.get();
+    ++track.numBlocksCached;
+    touch(track, blockIndex);
+    return block;
+}
+
+DecodedBlockCache::BlockPtr DecodedBlockCache::findBlock(Track& track, int blockIndex)
+{
+    if (!isPositiveAndBelow(blockIndex, track.numBlocks))
+        return nullptr;
+
+    const ScopedLock sl(lock);
+    if (track.blocks[blockIndex] == nullptr)
+        return nullptr;
+
+    ++hits;
+    touch(track, blockIndex);
+    return track.blocks[blockIndex];
+}
+
+bool DecodedBlockCache::readFromAudioThread(Track& track, int64 startSample, AudioBuffer<float>& dest,
+                                            int destStart, int numSamples)
+{
+    if (startSample < 0 || startSample + numSamples > track.lengthInSamples)
+        return false;
+
+    //keeps evicted blocks alive until this read is done
+    ++audioReaders;
+
+    //check everything first so a miss leaves dest untouched
+    int firstBlock = static_cast<int>(startSample / blockSize);
+    int lastBlock = static_cast<int>((startSample + numSamples - 1) / blockSize);
+    bool allCached = true;
+    for (int i = firstBlock; i <= lastBlock && allCached; ++i)
+        allCached = track.slots[i].load() != nullptr;
+
+    if (allCached)
+    {
+        int64 pos = startSample;
+        int done = 0;
+        while (done < numSamples)
+        {
+            int blockIndex = static_cast<int>(pos / blockSize);
+            const Block* block = track.slots[blockIndex].load();
+            if (block == nullptr)
+            {
+                //evicted between the check and the copy
+                allCached = false;
+                break;
+            }
+
+            int offset = static_cast<int>(pos - static_cast<int64>(blockIndex) * blockSize);
+            int num = jmin(numSamples - done, block->samples.getNumSamples() - offset);
+            const int blockChannels = block->samples.getNumChannels();
+            for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+            {
+                dest.copyFrom(channel, destStart + done, block->samples, jmin(channel, blockChannels - 1), offset, num);
+            }
+
+            track.lastUsed[blockIndex] = ++useClock;
+            pos += num;
+            done += num;
+        }
+    }
+
+    --audioReaders;
+
+    if (allCached)
+        ++hits;
+    else
+        ++misses;
+    return allCached;
+}
+
+void DecodedBlockCache::setMemoryLimit(size_t bytes)
+{
+    const ScopedLock sl(lock);
+    memoryLimit = bytes;
+    evictToLimit(0);
+    releaseRetired();
+}
+
+size_t DecodedBlockCache::getMemoryUsage() const
+{
+    const ScopedLock sl(lock);
+    return memoryUsage;
+}
+
+//==============================================================================
+void DecodedBlockCache::run()
+{
+    while (!threadShouldExit())
+    {
+        bool decoded = readAhead();
+
+        {
+            const ScopedLock sl(lock);
+            releaseRetired();
+            pruneTracks();
+        }
+
+        if (!decoded)
+            wait(idleWaitMs);
+    }
+}
+
+bool DecodedBlockCache::readAhead()
+{
+    TrackPtr track;
+    int missing = -1;
+    {
+        const ScopedLock sl(lock);
+        cursors.erase(std::remove_if(cursors.begin(), cursors.end(),
+                                     [](const std::weak_ptr<Cursor>& c) { return c.expired(); }),
+                      cursors.end());
+
+        for (auto& weakCursor : cursors)
+        {
+            auto cursor = weakCursor.lock();
+            if (cursor == nullptr)
+                continue;
+
+            int first = static_cast<int>(cursor->position / blockSize);
+            int last = jmin(first + readAheadBlocks, cursor->track->numBlocks);
+            for (int i = jmax(0, first); i < last; ++i)
+            {
+                if (cursor->track->blocks[i] == nullptr)
+                {
+                    track = cursor->track;
+                    missing = i;
+                    break;
+                }
+            }
+
+            if (missing >= 0)
+                break;
+        }
+    }
+
+    if (missing < 0)
+        return false;
+
+    getBlock(*track, missing);
+    return true;
+}
+
+void DecodedBlockCache::evictToLimit(size_t incomingBytes)
+{
+    while (memoryUsage + incomingBytes > memoryLimit)
+    {
+        //least recently used among the blocks only the cache holds
+        Track* victimTrack = nullptr;
+        int victimIndex = -1;
+        uint32 oldest = 0;
+        for (auto& [key, track] : tracks)
+        {
+            if (track->numBlocksCached == 0)
+                continue;
+
+            for (int i = 0; i < track->numBlocks; ++i)
+            {
+                if (track->blocks[i] == nullptr || track->blocks[i].use_count() > 1)
+                    continue;
+
+                uint32 used = track->lastUsed[i];
+                if (victimTrack == nullptr || used < oldest)
+                {
+                    victimTrack = track.get();
+                    victimIndex = i;
+                    oldest = used;
+                }
+            }
+        }
+
+        //everything left is in use, going over the limit beats failing a read
+        if (victimTrack == nullptr)
+            return;
+
+        victimTrack->slots[victimIndex] = nullptr;
+        memoryUsage -= getBlockBytes(*victimTrack->blocks[victimIndex]);
+        retired.push_back(std::move(victimTrack->blocks[victimIndex]));
+        victimTrack->blocks[victimIndex] = nullptr;
+        --victimTrack->numBlocksCached;
+    }
+}
+
+void DecodedBlockCache::releaseRetired()
+{
+    //the slots were cleared first, so a read starting now can't find these blocks
+    //and a read that found one is still counted
+    if (!retired.empty() && audioReaders.load() == 0)
+        retired.clear();
+}
+
+void DecodedBlockCache::pruneTracks()
+{
+    for (auto it = tracks.begin(); it != tracks.end();)
+    {
+        if (it->second.use_count() == 1 && it->second->numBlocksCached == 0)
+            it = tracks.erase(it);
+        else
+            ++it;
+    }
+}
+
+void DecodedBlockCache::touch(Track& track, int blockIndex)
+{
+    track.lastUsed[blockIndex] = ++useClock;
+}
+
+size_t DecodedBlockCache::getBlockBytes(const Block& block)
+{
+    return static_cast<size_t>(block.samples.getNumChannels()) * block.samples.getNumSamples() * sizeof(float);
+}
+
+//==============================================================================
+DecodedBlockReader::DecodedBlockReader(DecodedBlockCache& _cache, DecodedBlockCache::TrackPtr _track, bool _fillCache)
+    : AudioFormatReader(nullptr, "DecodedBlockReader"),
+      cache(_cache),
+      track(std::move(_track)),
+      fillCache(_fillCache)
+{
+    sampleRate = track->getSampleRate();
+    lengthInSamples = track->getLengthInSamples();
+    numChannels = static_cast<unsigned int>(track->getNumChannels());
+    bitsPerSample = 32;
+    usesFloatingPointData = true;
+}
+
+bool DecodedBlockReader::readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                                     int64 startSampleInFile, int numSamples)
+{
+    constexpr int blockSize = DecodedBlockCache::blockSize;
+
+    while (numSamples > 0)
+    {
+        if (startSampleInFile < 0 || startSampleInFile >= lengthInSamples)
+        {
+            //outside the file reads as silence
+            for (int channel = 0; channel < numDestChannels; ++channel)
+            {
+                if (destChannels[channel] != nullptr)
+                    zeromem(destChannels[channel] + startOffsetInDestBuffer, sizeof(float) * static_cast<size_t>(numSamples));
+            }
+            return true;
+        }
+
+        int blockIndex = static_cast<int>(startSampleInFile / blockSize);
+        int offset = static_cast<int>(startSampleInFile - static_cast<int64>(blockIndex) * blockSize);
+
+        if (blockIndex != currentBlockIndex)
+        {
+            currentBlock = fillCache ? cache.getBlock(*track, blockIndex) : cache.findBlock(*track, blockIndex);
+            currentBlockIndex = blockIndex;
+        }
+
+        const AudioBuffer<float>* source = currentBlock != nullptr ? &currentBlock->samples : nullptr;
+        if (source == nullptr)
+        {
+            //not cached and not ours to cache, decode the block privately
+            if (privateBlockIndex != blockIndex)
+            {
+                if (privateReader == nullptr)
+                    privateReader = cache.createPrivateReader(track->getFile());
+                if (privateReader == nullptr)
+                    return false;
+
+                int64 blockStart = static_cast<int64>(blockIndex) * blockSize;
+                int numFrames = static_cast<int>(jmin<int64>(blockSize, lengthInSamples - blockStart));
+                privateBuffer.setSize(static_cast<int>(numChannels), numFrames, false, false, true);
+                privateReader->read(&privateBuffer, 0, numFrames, blockStart, true, numChannels > 1);
+                privateBlockIndex = blockIndex;
+            }
+            source = &privateBuffer;
+        }
+
+        int num = jmin(numSamples, source->getNumSamples() - offset);
+        for (int channel = 0; channel < numDestChannels; ++channel)
+        {
+            if (destChannels[channel] == nullptr)
+                continue;
+
+            auto* dest = reinterpret_cast<float*>(destChannels[channel]) + startOffsetInDestBuffer;
+            const float* src = source->getReadPointer(jmin(channel, source->getNumChannels() - 1), offset);
+            std::copy(src, src + num, dest);
+        }
+
+        startOffsetInDestBuffer += num;
+        startSampleInFile += num;
+        numSamples -= num;
+    }
+    return true;
+}
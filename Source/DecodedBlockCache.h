@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    DecodedBlockCache.h
+    Created: 19 Oct 2026 4:11:09pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+/** Decoded audio shared by everything that reads a track: both decks, the
+    waveforms, the seek prefetcher and the analysis. A track loaded on both
+    decks is decoded once.
+
+    Tracks are split in fixed size blocks keyed by track and block index.
+    Blocks are reference counted and evicted least recently used first once
+    the cache goes over its memory limit; a block somebody still holds is
+    never evicted.
+
+    The audio thread reads through readFromAudioThread, which takes no lock
+    and never decodes: blocks are published through atomic pointers and an
+    evicted block is only freed once no audio read is in flight. Everything
+    else may block and decodes on a miss. **/
+class DecodedBlockCache : private Thread
+{
+public:
+    /** Frames per block, about 0.75s at 44.1kHz **/
+    static constexpr int blockSize = 32768;
+
+    struct Block
+    {
+        //at most two channels, the last block of a track is shorter
+        AudioBuffer<float> samples;
+    };
+    using BlockPtr = std::shared_ptr<const Block>;
+
+    /** A file opened through the cache, shared by everyone who opened it **/
+    class Track
+    {
+    public:
+        ~Track();
+
+        File getFile() const { return file; }
+        double getSampleRate() const { return sampleRate; }
+        int64 getLengthInSamples() const { return lengthInSamples; }
+        int getNumChannels() const { return numChannels; }
+        int getNumBlocks() const { return numBlocks; }
+
+    private:
+        friend class DecodedBlockCache;
+        Track(const File& file, std::unique_ptr<AudioFormatReader> reader);
+
+        const File file;
+        double sampleRate;
+        int64 lengthInSamples;
+        int numChannels;
+        int numBlocks;
+
+        //only used by whoever holds decodeLock
+        CriticalSection decodeLock;
+        std::unique_ptr<AudioFormatReader> reader;
+
+        //owned under the cache lock, published to the audio thread through slots
+        std::vector<BlockPtr> blocks;
+        int numBlocksCached = 0;
+        std::unique_ptr<std::atomic<const Block*>[]> slots;
+        std::unique_ptr<std::atomic<uint32>[]> lastUsed;
+
+        JUCE_DECLARE_NON_COPYABLE (Track)
+    };
+    using TrackPtr = std::shared_ptr<Track>;
+
+    /** Playhead of a consumer. The cache decodes a few blocks ahead of every
+    live cursor in the background, drop the pointer to remove it **/
+    struct Cursor
+    {
+        TrackPtr track;
+        std::atomic<int64> position{ 0 };
+    };
+    using CursorPtr = std::shared_ptr<Cursor>;
+
+    explicit DecodedBlockCache(AudioFormatManager& formatManager);
+    ~DecodedBlockCache() override;
+
+    /** The shared track for the file, nullptr when it can't be read **/
+    TrackPtr openTrack(const File& file);
+
+    /** Reader of the file that bypasses the cache, owned by the caller **/
+    std::unique_ptr<AudioFormatReader> createPrivateReader(const File& file);
+
+    CursorPtr addCursor(const TrackPtr& track);
+
+    /** The block, decoded first if it isn't cached. Blocking, never call it from the audio thread **/
+    BlockPtr getBlock(Track& track, int blockIndex);
+
+    /** The block when it is cached, without decoding **/
+    BlockPtr findBlock(Track& track, int blockIndex);
+
+    /** Copy numSamples from startSample into dest. Lock-free and never decodes,
+    returns false unless every block is cached, dest then has to be read elsewhere **/
+    bool readFromAudioThread(Track& track, int64 startSample, AudioBuffer<float>& dest, int destStart, int numSamples);
+
+    void setMemoryLimit(size_t bytes);
+    size_t getMemoryUsage() const;
+
+    int getHits() const { return hits.load(); }
+    int getMisses() const { return misses.load(); }
+
+private:
+    void run() override;
+
+    /** Decode one missing block ahead of a cursor, false when they are all covered **/
+    bool readAhead();
+
+    /** Evict unreferenced blocks until incomingBytes fit. Call with the lock held **/
+    void evictToLimit(size_t incomingBytes);
+
+    /** Free evicted blocks once no audio read can still see them. Call with the lock held **/
+    void releaseRetired();
+
+    /** Forget tracks nobody holds and nothing is cached for. Call with the lock held **/
+    void pruneTracks();
+
+    void touch(Track& track, int blockIndex);
+    static size_t getBlockBytes(const Block& block);
+
+    AudioFormatManager& formatManager;
+
+    CriticalSection lock;
+    std::map<String, TrackPtr> tracks;
+    std::vector<std::weak_ptr<Cursor>> cursors;
+    std::vector<BlockPtr> retired;
+    size_t memoryUsage = 0;
+    size_t memoryLimit;
+
+    //audio reads in flight, evicted blocks wait for it to drop to zero
+    std::atomic<int> audioReaders{ 0 };
+    std::atomic<uint32> useClock{ 0 };
+
+    std::atomic<int> hits{ 0 };
+    std::atomic<int> misses{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedBlockCache)
+};
+
+//==============================================================================
+/** AudioFormatReader over a cached track, for the waveform, the prefetcher and
+    the analysis. With fillCache off a miss is decoded by a private reader and
+    not kept, so a scan over many tracks doesn't flush what the decks play **/
+class DecodedBlockReader : public AudioFormatReader
+{
+public:
+    DecodedBlockReader(DecodedBlockCache& cache, DecodedBlockCache::TrackPtr track, bool fillCache);
+    ~DecodedBlockReader() override = default;
+
+    bool readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+                     int64 startSampleInFile, int numSamples) override;
+
+private:
+    DecodedBlockCache& cache;
+    DecodedBlockCache::TrackPtr track;
+    const bool fillCache;
+
+    //the last block read, consecutive reads mostly stay in it
+    DecodedBlockCache::BlockPtr currentBlock;
+    int currentBlockIndex = -1;
+
+    std::unique_ptr<AudioFormatReader> privateReader;
+    AudioBuffer<float> privateBuffer;
+    int privateBlockIndex = -1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedBlockReader)
+};
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+    Created: 20 Oct 2026 6:14:53am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+#include <cmath>
+
+namespace
+{
+    //like a PPM, a peak falls 20dB in 1.7s
+    constexpr double peakFallDecibels = 20.0;
+    constexpr double peakFallSeconds = 1.7;
+
+    constexpr double rmsTimeConstantSeconds = 0.3;
+
+    //levels under this are silence, kept out of the denormals
+    constexpr float silence = 1.0e-9f;
+
+    //the interpolator's passband, as a share of the input's Nyquist
+    constexpr double passband = 0.9;
+
+    float flushSilence(float level)
+    {
+        return level < silence ? 0.0f : level;
+    }
+}
+
+LevelMeter::LevelMeter()
+{
+    static_assert(Vec::SIMDNumElements >= oversampling, "one lane per phase");
+
+    //windowed sinc low pass at the input's Nyquist, split in its oversampling phases
+    constexpr int numTaps = oversampling * tapsPerPhase;
+    std::array<double, numTaps> taps;
+    for (int n = 0; n < numTaps; ++n)
+    {
+        double x = passband * (n - (numTaps - 1) / 2.0) / oversampling;
+        double sinc = x == 0.0 ? 1.0 : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+        double window = 0.5 - 0.5 * std::cos(MathConstants<double>::twoPi * (n + 0.5) / numTaps);
+        taps[static_cast<size_t>(n)] = sinc * window;
+    }
+
+    for (auto& coefficient : coefficients)
+        coefficient = Vec::expand(0.0f);
+
+    //every phase passes DC at unity
+    for (int phase = 0; phase < oversampling; ++phase)
+    {
+        double sum = 0.0;
+        for (int k = 0; k < tapsPerPhase; ++k)
+            sum += taps[static_cast<size_t>(k * oversampling + phase)];
+        for (int k = 0; k < tapsPerPhase; ++k)
+            coefficients[static_cast<size_t>(k)].set(static_cast<size_t>(phase),
+                static_cast<float>(taps[static_cast<size_t>(k * oversampling + phase)] / sum));
+    }
+}
+
+void LevelMeter::prepare(double sampleRate)
+{
+    peakRelease = std::pow(10.0, -peakFallDecibels / 20.0 / (peakFallSeconds * sampleRate));
+    rmsTimeConstantSamples = rmsTimeConstantSeconds * sampleRate;
+
+    levels = MeterLevels();
+    meanSquare.fill(0.0f);
+    for (auto& past : history)
+        past.fill(0.0f);
+    historyPosition.fill(0);
+}
+
+void LevelMeter::process(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int numChannels = jmin(MeterLevels::maxChannels, buffer.getNumChannels());
+    levels.numChannels = numChannels;
+    if (numSamples <= 0)
+        return;
+
+    //the ballistics move once per block
+    float fall = static_cast<float>(std::pow(peakRelease, numSamples));
+    float smoothing = static_cast<float>(1.0 - std::exp(-numSamples / rmsTimeConstantSamples));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto index = static_cast<size_t>(channel);
+        const float* samples = buffer.getReadPointer(channel, startSample);
+
+        auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+        float blockPeak = jmax(-range.getStart(), range.getEnd());
+        levels.peak[index] = flushSilence(jmax(blockPeak, levels.peak[index] * fall));
+
+        float blockTruePeak = jmax(blockPeak, findTruePeak(channel, samples, numSamples));
+        levels.truePeak[index] = flushSilence(jmax(blockTruePeak, levels.truePeak[index] * fall));
+
+        float blockMeanSquare = sumOfSquares(samples, numSamples) / numSamples;
+        meanSquare[index] = flushSilence(meanSquare[index] + (blockMeanSquare - meanSquare[index]) * smoothing);
+        levels.rms[index] = std::sqrt(meanSquare[index]);
+    }
+}
+
+float LevelMeter::sumOfSquares(const float* samples, int numSamples)
+{
+    constexpr int lanes = static_cast<int>(Vec::SIMDNumElements);
+    float sum = 0.0f;
+    int i = 0;
+
+    //one at a time up to the first aligned sample, the vector loads need it
+    for (; i < numSamples && !Vec::isSIMDAligned(samples + i); ++i)
+        sum += samples[i] * samples[i];
+
+    auto squares = Vec::expand(0.0f);
+    for (; i + lanes <= numSamples; i += lanes)
+    {
+        auto block = Vec::fromRawArray(samples + i);
+        squares += block * block;
+    }
+    sum += squares.sum();
+
+    for (; i < numSamples; ++i)
+        sum += samples[i] * samples[i];
+    return sum;
+}
+
+float LevelMeter::findTruePeak(int channel, const float* samples, int numSamples)
+{
+    auto index = static_cast<size_t>(channel);
+    auto& past = history[index];
+    int position = historyPosition[index];
+
+    auto highest = Vec::expand(0.0f);
+    auto lowest = Vec::expand(0.0f);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        //newest first, past[position + k] is k samples ago
+        position = (position == 0 ? tapsPerPhase : position) - 1;
+        past[static_cast<size_t>(position)] = samples[i];
+        past[static_cast<size_t>(position + tapsPerPhase)] = samples[i];
+
+        //the four interpolated points after this sample, one per lane
+        auto interpolated = Vec::expand(0.0f);
+        for (int k = 0; k < tapsPerPhase; ++k)
+            interpolated += coefficients[static_cast<size_t>(k)] * past[static_cast<size_t>(position + k)];
+
+        highest = Vec::max(highest, interpolated);
+        lowest = Vec::min(lowest, interpolated);
+    }
+    historyPosition[index] = position;
+
+    float peak = 0.0f;
+    for (size_t lane = 0; lane < static_cast<size_t>(oversampling); ++lane)
+        peak = jmax(peak, highest.get(lane), -lowest.get(lane));
+    return peak;
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 20 Oct 2026 6:14:53am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+/** Levels of one meter in linear gain, 1 is full scale **/
+struct MeterLevels
+{
+    static constexpr int maxChannels = 2;
+
+    std::array<float, maxChannels> peak{};
+    std::array<float, maxChannels> rms{};
+    //between the samples, from the signal oversampled 4 times
+    std::array<float, maxChannels> truePeak{};
+    int numChannels = 0;
+};
+
+/** Peak, RMS and true peak of the signal going through it, measured in the
+    audio callback. Peaks hold and fall back like a PPM and RMS is averaged
+    over a few hundred milliseconds, so a GUI reading them once a frame
+    misses nothing between two frames.
+
+    The work is vectorised: the peak through FloatVectorOperations, the sum
+    of squares and the four phases of the true peak interpolator through
+    dsp::SIMDRegister. Nothing allocates or locks after prepare. **/
+class LevelMeter
+{
+public:
+    LevelMeter();
+
+    /** Set the ballistics for the sample rate, not on the audio thread **/
+    void prepare(double sampleRate);
+
+    /** Measure the first two channels of the block, on the audio thread **/
+    void process(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** The levels as of the last block, read on the audio thread after process **/
+    const MeterLevels& getLevels() const { return levels; }
+
+private:
+    using Vec = dsp::SIMDRegister<float>;
+
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    /** Sum of the squares of the samples **/
+    static float sumOfSquares(const float* samples, int numSamples);
+
+    /** Largest magnitude between and on the samples, carries the interpolator's history **/
+    float findTruePeak(int channel, const float* samples, int numSamples);
+
+    MeterLevels levels;
+
+    //per sample, the peaks fall 20dB in 1.7s
+    double peakRelease = 1.0;
+    double rmsTimeConstantSamples = 1.0;
+    std::array<float, MeterLevels::maxChannels> meanSquare{};
+
+    //one lane per phase, tap k of every phase in coefficients[k]
+    std::array<Vec, tapsPerPhase> coefficients;
+    //last input samples, written twice so tapsPerPhase of them are always contiguous
+    std::array<std::array<float, tapsPerPhase * 2>, MeterLevels::maxChannels> history{};
+    std::array<int, MeterLevels::maxChannels> historyPosition{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    LevelMeterDisplay.cpp
+    Created: 20 Oct 2026 6:14:53am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LevelMeterDisplay.h"
+#include "PaintProfiler.h"
+
+namespace
+{
+    //bottom and top of the scale
+    constexpr float minDecibels = -60.0f;
+    constexpr float maxDecibels = 3.0f;
+
+    //where the bars turn yellow and red
+    constexpr float warnDecibels = -9.0f;
+    constexpr float clipDecibels = 0.0f;
+
+    constexpr int clipCellHeight = 4;
+}
+
+LevelMeterDisplay::LevelMeterDisplay()
+{
+    setOpaque(true);
+    setInterceptsMouseClicks(false, false);
+}
+
+LevelMeterDisplay::~LevelMeterDisplay()
+{
+}
+
+int LevelMeterDisplay::getBarHeight(float level) const
+{
+    float decibels = Decibels::gainToDecibels(level, minDecibels);
+    float proportion = (decibels - minDecibels) / (maxDecibels - minDecibels);
+    return roundToInt(jlimit(0.0f, 1.0f, proportion) * (getHeight() - clipCellHeight - 1));
+}
+
+void LevelMeterDisplay::setLevels(const MeterLevels& newLevels)
+{
+    bool changed = false;
+    for (int channel = 0; channel < MeterLevels::maxChannels; ++channel)
+    {
+        auto index = static_cast<size_t>(channel);
+        bool present = channel < newLevels.numChannels;
+        int rms = present ? getBarHeight(newLevels.rms[index]) : 0;
+        int peak = present ? getBarHeight(newLevels.peak[index]) : 0;
+        bool clip = present && newLevels.truePeak[index] > 1.0f;
+
+        if (rms != shownRms[index] || peak != shownPeak[index] || clip != shownClip[index])
+            changed = true;
+        shownRms[index] = rms;
+        shownPeak[index] = peak;
+        shownClip[index] = clip;
+    }
+
+    if (changed)
+        repaint();
+}
+
+void LevelMeterDisplay::paint(Graphics& g)
+{
+    PaintProfiler::Scope profile("LevelMeterDisplay::paint");
+    g.fillAll(Colour(0xFF151515));
+
+    int barBottom = getHeight() - 1;
+    int numBars = MeterLevels::maxChannels;
+    int barWidth = jmax(1, (getWidth() - (numBars + 1)) / numBars);
+    int warnHeight = getBarHeight(Decibels::decibelsToGain(warnDecibels));
+    int clipHeight = getBarHeight(Decibels::decibelsToGain(clipDecibels));
+
+    for (int channel = 0; channel < numBars; ++channel)
+    {
+        auto index = static_cast<size_t>(channel);
+        int x = 1 + channel * (barWidth + 1);
+
+        //green, yellow over -9dB and red over full scale, like a console
+        int rms = shownRms[index];
+        g.setColour(Colour(0xFF1DB954));
+        g.fillRect(x, barBottom - jmin(rms, warnHeight), barWidth, jmin(rms, warnHeight));
+        if (rms > warnHeight)
+        {
+            g.setColour(Colours::yellow);
+            g.fillRect(x, barBottom - jmin(rms, clipHeight), barWidth, jmin(rms, clipHeight) - warnHeight);
+        }
+        if (rms > clipHeight)
+        {
+            g.setColour(Colours::red);
+            g.fillRect(x, barBottom - rms, barWidth, rms - clipHeight);
+        }
+
+        int peak = shownPeak[index];
+        if (peak > 0)
+        {
+            g.setColour(Colours::whitesmoke.withAlpha(0.8f));
+            g.fillRect(x, barBottom - peak, barWidth, 1);
+        }
+
+        g.setColour(shownClip[index] ? Colours::red : Colours::darkgrey.withAlpha(0.4f));
+        g.fillRect(x, 0, barWidth, clipCellHeight);
+    }
+}
@@ -0,0 +1,40 @@
+/*
+  ==============================================================================
+
+    LevelMeterDisplay.h
+    Created: 20 Oct 2026 6:14:53am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "LevelMeter.h"
+
+/** Vertical bars for a LevelMeter, one per channel: RMS filled, the peak as
+    a line over it and the top cell lit red while the true peak is over full
+    scale. Fed once per frame, it repaints only when a bar moves a pixel. **/
+class LevelMeterDisplay : public Component
+{
+public:
+    LevelMeterDisplay();
+    ~LevelMeterDisplay() override;
+
+    void setLevels(const MeterLevels& newLevels);
+
+    void paint(Graphics& g) override;
+
+private:
+    /** Height of the bar for a linear level, on a decibel scale **/
+    int getBarHeight(float level) const;
+
+    //what is on screen, a frame that doesn't change it isn't repainted
+    std::array<int, MeterLevels::maxChannels> shownRms{};
+    std::array<int, MeterLevels::maxChannels> shownPeak{};
+    std::array<bool, MeterLevels::maxChannels> shownClip{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterDisplay)
+};
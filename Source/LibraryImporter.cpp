@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    LibraryImporter.cpp
+    Created: 19 Oct 2026 9:41:26pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LibraryImporter.h"
+#include "ContentHash.h"
+#include "PlaylistFile.h"
+
+namespace
+{
+    //files opened by one pool job, small enough to spread a folder over every thread
+    constexpr int probeChunkSize = 32;
+
+    //how often probed tracks are handed to the message thread
+    constexpr int batchIntervalMs = 100;
+}
+
+LibraryImporter::LibraryImporter(AudioFormatManager& _formatManager)
+    : formatManager(_formatManager),
+      //opening a file mostly waits on the disk, one thread is left for the decks and the UI
+      pool(jmax(1, SystemStats::getNumCpus() - 1))
+{
+}
+
+LibraryImporter::~LibraryImporter()
+{
+    cancel();
+}
+
+void LibraryImporter::importAsync(const StringArray& paths, const std::unordered_set<std::string>& knownPaths)
+{
+    {
+        const ScopedLock sl(lock);
+        beginImport();
+        seenPaths.insert(knownPaths.begin(), knownPaths.end());
+    }
+
+    ++pendingJobs;
+    pool.addJob([this, paths] { scan(paths); });
+    startTimer(batchIntervalMs);
+}
+
+void LibraryImporter::fingerprintAsync(const std::vector<TrackInfo>& tracks)
+{
+    {
+        const ScopedLock sl(lock);
+        beginImport();
+        //an import of the same folders doesn't open them again
+        for (const auto& track : tracks)
+            seenPaths.insert(track.path);
+        progress.numFound += static_cast<int>(tracks.size());
+    }
+
+    for (size_t begin = 0; begin < tracks.size(); begin += probeChunkSize)
+    {
+        std::vector<TrackInfo> chunk(tracks.begin() + static_cast<std::ptrdiff_t>(begin),
+                                     tracks.begin() + static_cast<std::ptrdiff_t>(jmin(begin + probeChunkSize, tracks.size())));
+        ++pendingJobs;
+        pool.addJob([this, chunk = std::move(chunk)]() mutable { fingerprint(std::move(chunk)); });
+    }
+    startTimer(batchIntervalMs);
+}
+
+void LibraryImporter::beginImport()
+{
+    if (!isImporting())
+    {
+        seenPaths.clear();
+        progress = Progress();
+    }
+    progress.finished = false;
+}
+
+void LibraryImporter::cancel()
+{
+    stopTimer();
+    cancelled = true;
+    pool.removeAllJobs(true, 4000);
+    cancelled = false;
+    pendingJobs = 0;
+
+    const ScopedLock sl(lock);
+    probed.clear();
+    progress.finished = true;
+}
+
+//==============================================================================
+void LibraryImporter::timerCallback()
+{
+    //read before taking the tracks, a job only finishes after handing its tracks over
+    bool done = pendingJobs == 0;
+
+    std::vector<TrackInfo> tracks;
+    Progress current;
+    {
+        const ScopedLock sl(lock);
+        tracks.swap(probed);
+        progress.numAdded += static_cast<int>(tracks.size());
+        progress.finished = done;
+        current = progress;
+    }
+
+    if (!tracks.empty() && onTracksProbed != nullptr)
+        onTracksProbed(tracks);
+
+    if (done)
+    {
+        stopTimer();
+        std::cout << "LibraryImporter::timerCallback - added " << current.numAdded
+                  << ", skipped " << current.numSkipped << std::endl;
+    }
+
+    if ((done || !tracks.empty()) && onProgress != nullptr)
+        onProgress(current);
+}
+
+void LibraryImporter::scan(const StringArray& paths)
+{
+    const String wildcard = formatManager.getWildcardForAllFormats();
+
+    std::vector<File> files;
+    for (const auto& path : paths)
+    {
+        File file(path);
+        if (file.isDirectory())
+        {
+            for (const auto& entry : RangedDirectoryIterator(file, true, wildcard, File::findFiles))
+            {
+                if (cancelled)
+                    break;
+                files.push_back(entry.getFile());
+            }
+        }
+        else if (PlaylistFile::getFormat(file) != PlaylistFile::Format::none)
+        {
+            scanPlaylist(file, files);
+        }
+        else if (formatManager.findFormatForFileExtension(file.getFileExtension()) != nullptr)
+        {
+            files.push_back(file);
+        }
+    }
+
+    //files the library already has aren't opened, moved ones are matched by content later
+    std::vector<File> newFiles;
+    {
+        const ScopedLock sl(lock);
+        for (const auto& file : files)
+        {
+            if (seenPaths.insert(file.getFullPathName().toStdString()).second)
+                newFiles.push_back(file);
+            else
+                ++progress.numSkipped;
+        }
+        progress.numFound += static_cast<int>(newFiles.size());
+    }
+
+    for (size_t begin = 0; begin < newFiles.size() && !cancelled; begin += probeChunkSize)
+    {
+        std::vector<File> chunk(newFiles.begin() + static_cast<std::ptrdiff_t>(begin),
+                                newFiles.begin() + static_cast<std::ptrdiff_t>(jmin(begin + probeChunkSize, newFiles.size())));
+        ++pendingJobs;
+        pool.addJob([this, chunk] { probe(chunk); });
+    }
+
+    --pendingJobs;
+}
+
+void LibraryImporter::scanPlaylist(const File& playlist, std::vector<File>& files)
+{
+    //json entries have everything already and go straight to the library,
+    //m3u and pls ones are only paths and get opened like any other file
+    bool complete = PlaylistFile::getFormat(playlist) == PlaylistFile::Format::json;
+    PlaylistFile::read(playlist, [this, complete, &files](TrackInfo&& track)
+    {
+        File file(track.path);
+        if (cancelled || formatManager.findFormatForFileExtension(file.getFileExtension()) == nullptr)
+            return;
+
+        if (!complete)
+        {
+            files.push_back(file);
+            return;
+        }
+
+        const ScopedLock sl(lock);
+        if (seenPaths.insert(track.path).second)
+        {
+            ++progress.numFound;
+            ++progress.numProbed;
+            probed.push_back(std::move(track));
+        }
+        else
+        {
+            ++progress.numSkipped;
+        }
+    });
+}
+
+void LibraryImporter::probe(const std::vector<File>& files)
+{
+    std::vector<TrackInfo> tracks;
+    tracks.reserve(files.size());
+
+    for (const auto& file : files)
+    {
+        if (cancelled)
+            break;
+
+        //only the header is read, the reader goes as soon as the duration is known
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (reader == nullptr || reader->sampleRate <= 0.0)
+        {
+            std::cout << "LibraryImporter::probe - can't read " << file.getFullPathName() << std::endl;
+            continue;
+        }
+
+        TrackInfo track;
+        track.title = file.getFileName().toStdString();
+        track.path = file.getFullPathName().toStdString();
+        track.durationSeconds = reader->lengthInSamples / reader->sampleRate;
+        reader.reset();
+        track.contentHash = ContentHash::ofFile(file);
+        tracks.push_back(std::move(track));
+    }
+
+    {
+        const ScopedLock sl(lock);
+        probed.insert(probed.end(), std::make_move_iterator(tracks.begin()), std::make_move_iterator(tracks.end()));
+        progress.numProbed += static_cast<int>(files.size());
+    }
+
+    --pendingJobs;
+}
+
+void LibraryImporter::fingerprint(std::vector<TrackInfo> tracks)
+{
+    std::vector<TrackInfo> fingerprinted;
+    fingerprinted.reserve(tracks.size());
+
+    for (auto& track : tracks)
+    {
+        if (cancelled)
+            break;
+
+        //unreadable files keep their row without a hash, as they were
+        track.contentHash = ContentHash::ofFile(File(track.path));
+        if (track.contentHash != 0)
+            fingerprinted.push_back(std::move(track));
+    }
+
+    {
+        const ScopedLock sl(lock);
+        probed.insert(probed.end(), std::make_move_iterator(fingerprinted.begin()), std::make_move_iterator(fingerprinted.end()));
+        progress.numProbed += static_cast<int>(tracks.size());
+    }
+
+    --pendingJobs;
+}
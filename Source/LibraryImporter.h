@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    LibraryImporter.h
+    Created: 19 Oct 2026 9:41:26pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "LibraryIndex.h"
+
+/** Bulk import of files, whole folders and playlists. Folders are walked
+    and every new audio file is opened to read its duration and fingerprinted
+    with ContentHash on a pool of threads; the tracks found are handed to the
+    message thread in batches, a few times a second, together with the
+    progress so far. **/
+class LibraryImporter : private Timer
+{
+public:
+    struct Progress
+    {
+        int numFound = 0;       // new audio files found so far
+        int numProbed = 0;      // of those, opened or given up on
+        int numAdded = 0;       // handed to onTracksProbed
+        int numSkipped = 0;     // already in the library, or found twice
+        bool finished = true;
+    };
+
+    /** Called on the message thread with the tracks probed since the last call **/
+    std::function<void(const std::vector<TrackInfo>& tracks)> onTracksProbed;
+
+    /** Called on the message thread after every batch and once finished **/
+    std::function<void(const Progress& progress)> onProgress;
+
+    explicit LibraryImporter(AudioFormatManager& formatManager);
+    ~LibraryImporter() override;
+
+    /** Import the files and every audio file in the folders below paths.
+    Files in knownPaths are skipped without being opened, as is a file found
+    twice. Another import while one runs joins it **/
+    void importAsync(const StringArray& paths, const std::unordered_set<std::string>& knownPaths);
+
+    /** Fingerprint tracks the library has from before content hashes and hand
+    them back with their hash set. Only the ContentHash reads are done, the
+    files aren't opened by a decoder again. Joins an import that runs **/
+    void fingerprintAsync(const std::vector<TrackInfo>& tracks);
+
+    /** Drop whatever hasn't been handed over yet **/
+    void cancel();
+
+    bool isImporting() const { return isTimerRunning(); }
+
+private:
+    void timerCallback() override;
+
+    /** Walk paths and queue the new files in chunks, on the pool **/
+    void scan(const StringArray& paths);
+
+    /** Add the files of a playlist to files, or the tracks of a json one
+    straight to the probed tracks **/
+    void scanPlaylist(const File& playlist, std::vector<File>& files);
+
+    /** Open and fingerprint every file of a chunk and keep the ones that read, on the pool **/
+    void probe(const std::vector<File>& files);
+
+    /** Set the content hash of every track of a chunk that reads, on the pool **/
+    void fingerprint(std::vector<TrackInfo> tracks);
+
+    /** Reset the progress unless an import runs, under the lock **/
+    void beginImport();
+
+    AudioFormatManager& formatManager;
+    ThreadPool pool;
+
+    //jobs queued or running, the import is done when it is back to 0
+    std::atomic<int> pendingJobs{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    CriticalSection lock;
+    std::unordered_set<std::string> seenPaths;
+    std::vector<TrackInfo> probed;
+    Progress progress;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryImporter)
+};
@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    LibraryIndex.cpp
+    Created: 19 Oct 2026 7:34:52pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LibraryIndex.h"
+#include "ContentHash.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+std::string TrackInfo::getKey(const std::string& title, uint64 contentHash)
+{
+    return contentHash != 0 ? ContentHash::toString(contentHash) : title;
+}
+
+//==============================================================================
+bool LibraryIndex::open(const File& file)
+{
+    close();
+
+    if (!file.existsAsFile())
+        return false;
+
+    auto mapped = std::make_unique<MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+    const char* data = static_cast<const char*>(mapped->getData());
+    const uint64_t size = mapped->getSize();
+    if (data == nullptr || size < sizeof(Header))
+    {
+        std::cout << "LibraryIndex::open - can't map " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    //every section has to lie inside the file, a bad index is ignored rather than trusted
+    bool valid = std::memcmp(header.magic, magic, sizeof(magic)) == 0
+        && header.version >= 1 && header.version <= currentVersion
+        && header.recordSize == recordSizes[header.version - 1]
+        && header.numberPoolOffset % alignof(double) == 0
+        && header.numRecords <= (size - std::min<uint64_t>(size, header.recordsOffset)) / header.recordSize
+        && header.stringPoolOffset <= size && header.stringPoolSize <= size - header.stringPoolOffset
+        && header.numberPoolOffset <= size
+        && header.numberPoolCount <= (size - header.numberPoolOffset) / sizeof(double);
+    if (!valid)
+    {
+        std::cout << "LibraryIndex::open - not a valid index: " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    mappedFile = std::move(mapped);
+    numTracks = static_cast<int>(header.numRecords);
+    records = data + header.recordsOffset;
+    recordSize = header.recordSize;
+    stringPool = data + header.stringPoolOffset;
+    stringPoolSize = header.stringPoolSize;
+    numberPool = reinterpret_cast<const double*>(data + header.numberPoolOffset);
+    numberPoolCount = header.numberPoolCount;
+    return true;
+}
+
+void LibraryIndex::close()
+{
+    mappedFile.reset();
+    numTracks = 0;
+    records = nullptr;
+    recordSize = 0;
+    stringPool = nullptr;
+    stringPoolSize = 0;
+    numberPool = nullptr;
+    numberPoolCount = 0;
+}
+
+std::string LibraryIndex::getTitle(int index) const
+{
+    Record record = getRecord(index);
+    return getString(record.titleOffset, record.titleLength);
+}
+
+std::string LibraryIndex::getPath(int index) const
+{
+    Record record = getRecord(index);
+    return getString(record.pathOffset, record.pathLength);
+}
+
+double LibraryIndex::getDuration(int index) const
+{
+    return getRecord(index).durationSeconds;
+}
+
+int64 LibraryIndex::getDateAdded(int index) const
+{
+    return getRecord(index).dateAdded;
+}
+
+uint64 LibraryIndex::getContentHash(int index) const
+{
+    return getRecord(index).contentHash;
+}
+
+bool LibraryIndex::hasBeatGrid(int index) const
+{
+    return getRecord(index).beatGridCount > 0;
+}
+
+TrackTags LibraryIndex::getTags(int index) const
+{
+    Record record = getRecord(index);
+    TrackTags tags;
+    tags.artist = getString(record.tagsOffset, record.artistLength);
+    tags.title = getString(record.tagsOffset + record.artistLength, record.tagTitleLength);
+    tags.key = getString(record.tagsOffset + record.artistLength + record.tagTitleLength, record.keyLength);
+    tags.bpm = record.tagBpm;
+    return tags;
+}
+
+bool LibraryIndex::areTagsRead(int index) const
+{
+    return (getRecord(index).flags & tagsReadFlag) != 0;
+}
+
+std::vector<double> LibraryIndex::getBeatGrid(int index) const
+{
+    Record record = getRecord(index);
+    if (record.beatGridOffset > numberPoolCount || record.beatGridCount > numberPoolCount - record.beatGridOffset)
+        return {};
+
+    const double* begin = numberPool + record.beatGridOffset;
+    return std::vector<double>(begin, begin + record.beatGridCount);
+}
+
+TrackInfo LibraryIndex::getTrack(int index) const
+{
+    TrackInfo track;
+    track.title = getTitle(index);
+    track.path = getPath(index);
+    track.durationSeconds = getDuration(index);
+    track.beatGrid = getBeatGrid(index);
+    track.dateAdded = getDateAdded(index);
+    track.contentHash = getContentHash(index);
+    track.tags = getTags(index);
+    track.tagsRead = areTagsRead(index);
+    return track;
+}
+
+LibraryIndex::Record LibraryIndex::getRecord(int index) const
+{
+    static_assert(offsetof(Record, dateAdded) == recordSizes[0] && offsetof(Record, contentHash) == recordSizes[1]
+                  && offsetof(Record, tagsOffset) == recordSizes[2] && sizeof(Record) == recordSizes[currentVersion - 1],
+                  "every version only adds fields at the end of the record");
+    jassert(isPositiveAndBelow(index, numTracks));
+
+    //copied, the records of older versions are shorter and may not be aligned
+    Record record{};
+    std::memcpy(&record, records + static_cast<size_t>(index) * recordSize, recordSize);
+    return record;
+}
+
+std::string LibraryIndex::getString(uint64_t offset, uint32_t length) const
+{
+    if (offset > stringPoolSize || length > stringPoolSize - offset)
+        return {};
+
+    return std::string(stringPool + offset, length);
+}
+
+//==============================================================================
+bool LibraryIndex::write(const File& file, std::vector<TrackInfo> tracks)
+{
+    std::sort(tracks.begin(), tracks.end(),
+              [](const TrackInfo& a, const TrackInfo& b) { return a.title < b.title; });
+
+    std::vector<Record> newRecords;
+    newRecords.reserve(tracks.size());
+    std::string strings;
+    std::vector<double> numbers;
+
+    for (const auto& track : tracks)
+    {
+        Record record{};
+        record.titleOffset = strings.size();
+        record.titleLength = static_cast<uint32_t>(track.title.size());
+        strings += track.title;
+        record.pathOffset = strings.size();
+        record.pathLength = static_cast<uint32_t>(track.path.size());
+        strings += track.path;
+        record.durationSeconds = track.durationSeconds;
+        record.beatGridOffset = numbers.size();
+        record.beatGridCount = static_cast<uint32_t>(track.beatGrid.size());
+        record.dateAdded = track.dateAdded;
+        record.contentHash = track.contentHash;
+        record.flags = track.tagsRead ? tagsReadFlag : 0;
+        record.tagsOffset = strings.size();
+        record.artistLength = static_cast<uint32_t>(track.tags.artist.size());
+        record.tagTitleLength = static_cast<uint32_t>(track.tags.title.size());
+        record.keyLength = static_cast<uint32_t>(track.tags.key.size());
+        strings += track.tags.artist;
+        strings += track.tags.title;
+        strings += track.tags.key;
+        record.tagBpm = track.tags.bpm;
+        numbers.insert(numbers.end(), track.beatGrid.begin(), track.beatGrid.end());
+        newRecords.push_back(record);
+    }
+
+    //records right after the header, numbers after the strings padded to 8 bytes
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = currentVersion;
+    header.recordSize = sizeof(Record);
+    header.numRecords = newRecords.size();
+    header.recordsOffset = sizeof(Header);
+    header.stringPoolOffset = header.recordsOffset + newRecords.size() * sizeof(Record);
+    header.stringPoolSize = strings.size();
+    uint64_t padding = (alignof(double) - (header.stringPoolOffset + strings.size()) % alignof(double)) % alignof(double);
+    header.numberPoolOffset = header.stringPoolOffset + strings.size() + padding;
+    header.numberPoolCount = numbers.size();
+
+    TemporaryFile temp(file);
+    {
+        FileOutputStream out(temp.getFile());
+        if (out.failedToOpen())
+        {
+            std::cout << "LibraryIndex::write - can't write " << temp.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        const char zeros[alignof(double)] = {};
+        out.write(&header, sizeof(Header));
+        out.write(newRecords.data(), newRecords.size() * sizeof(Record));
+        out.write(strings.data(), strings.size());
+        out.write(zeros, static_cast<size_t>(padding));
+        out.write(numbers.data(), numbers.size() * sizeof(double));
+        out.flush();
+
+        if (out.getStatus().failed())
+        {
+            std::cout << "LibraryIndex::write - " << out.getStatus().getErrorMessage() << std::endl;
+            return false;
+        }
+    }
+
+    //renaming over a mapped index is fine on POSIX, on Windows it fails while mapped
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    LibraryIndex.h
+    Created: 19 Oct 2026 7:34:52pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** What the tags of a file say about its track, read by TagReader **/
+struct TrackTags
+{
+    std::string artist;
+    std::string title;
+    std::string key;                    // as written in the tag, e.g. "Am" or "8A"
+    double bpm = 0.0;                   // 0 when the file has none
+};
+
+/** Everything the library stores about a track **/
+struct TrackInfo
+{
+    std::string title;                  // file name
+    std::string path;
+    double durationSeconds = 0.0;
+    std::vector<double> beatGrid;       // BeatGrid::toArray, empty until analysed
+    int64 dateAdded = 0;                // milliseconds since 1970
+    uint64 contentHash = 0;             // ContentHash::ofFile, 0 until hashed
+    TrackTags tags;
+    bool tagsRead = false;              // tags is what the file has, even if that is nothing
+
+    /** What the library knows the track by: the content hash, or the title
+    for tracks from before content hashes until they are hashed **/
+    std::string getKey() const { return getKey(title, contentHash); }
+    static std::string getKey(const std::string& title, uint64 contentHash);
+};
+
+/** Read-only view of the binary library index, memory mapped so opening it
+    costs the same for a hundred tracks or a hundred thousand: nothing is read
+    until a track is asked for.
+
+    The file is a header, one fixed size record per track, a pool of UTF-8
+    strings and a pool of doubles for the beat grids, all in the byte order of
+    the machine that wrote it. Records are sorted by title. **/
+class LibraryIndex
+{
+public:
+    LibraryIndex() = default;
+    ~LibraryIndex() = default;
+
+    /** Map the file, false (and no tracks) when it is missing or not a valid index **/
+    bool open(const File& file);
+    void close();
+
+    int getNumTracks() const { return numTracks; }
+
+    std::string getTitle(int index) const;
+    std::string getPath(int index) const;
+    double getDuration(int index) const;
+    int64 getDateAdded(int index) const;
+    uint64 getContentHash(int index) const;
+    bool hasBeatGrid(int index) const;
+    TrackTags getTags(int index) const;
+    bool areTagsRead(int index) const;
+    std::vector<double> getBeatGrid(int index) const;
+    TrackInfo getTrack(int index) const;
+
+    /** Write tracks, sorted by title, as a new index replacing file. Written to a
+    temporary file first and renamed, a crash leaves the old index in place **/
+    static bool write(const File& file, std::vector<TrackInfo> tracks);
+
+private:
+    static constexpr char magic[8] = { 'O', 'T', 'O', 'L', 'I', 'B', '\0', '\0' };
+    //records of older versions are a prefix of the current one, the fields
+    //they don't have are read as 0
+    static constexpr uint32_t currentVersion = 4;
+    static constexpr uint32_t recordSizes[] = { 48, 56, 64, 96 };
+
+    //bits of Record::flags
+    static constexpr uint32_t tagsReadFlag = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t numRecords;
+        uint64_t recordsOffset;
+        uint64_t stringPoolOffset;
+        uint64_t stringPoolSize;
+        uint64_t numberPoolOffset;
+        uint64_t numberPoolCount;
+    };
+
+    struct Record
+    {
+        uint64_t titleOffset;           // into the string pool
+        uint64_t pathOffset;
+        uint32_t titleLength;
+        uint32_t pathLength;
+        double durationSeconds;
+        uint64_t beatGridOffset;        // into the number pool
+        uint32_t beatGridCount;
+        uint32_t flags;                 // tagsReadFlag since version 4, 0 before
+        int64_t dateAdded;              // since version 2
+        uint64_t contentHash;           // since version 3
+        uint64_t tagsOffset;            // since version 4, artist, title and key one after the other
+        uint32_t artistLength;
+        uint32_t tagTitleLength;
+        uint32_t keyLength;
+        uint32_t reserved;
+        double tagBpm;
+    };
+
+    /** Copy of a record, fields the file's version doesn't have are 0 **/
+    Record getRecord(int index) const;
+    std::string getString(uint64_t offset, uint32_t length) const;
+
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    int numTracks = 0;
+    const char* records = nullptr;
+    uint32_t recordSize = 0;
+    const char* stringPool = nullptr;
+    uint64_t stringPoolSize = 0;
+    const double* numberPool = nullptr;
+    uint64_t numberPoolCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryIndex)
+};
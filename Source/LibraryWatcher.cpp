@@ -0,0 +1,218 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.cpp
+    Created: 20 Oct 2026 12:37:45am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LibraryWatcher.h"
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+    //a batch goes once nothing happened for this long
+    constexpr uint32 quietMs = 500;
+
+    //or after this long, so a long copy still shows up as it goes
+    constexpr uint32 maxDelayMs = 3000;
+}
+
+LibraryWatcher::LibraryWatcher()
+    : Thread("LibraryWatcher")
+{
+   #if JUCE_LINUX
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+        std::cout << "LibraryWatcher - inotify not available" << std::endl;
+    else
+        startThread();
+   #endif
+}
+
+LibraryWatcher::~LibraryWatcher()
+{
+    stopTimer();
+    stopThread(2000);
+
+   #if JUCE_LINUX
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+   #endif
+}
+
+void LibraryWatcher::watch(const File& folder)
+{
+    if (inotifyFd < 0 || !folder.isDirectory())
+        return;
+
+    {
+        const ScopedLock sl(lock);
+        if (roots.contains(folder.getFullPathName()))
+            return;
+        roots.add(folder.getFullPathName());
+        foldersToWalk.add(folder.getFullPathName());
+    }
+
+    startTimer(static_cast<int>(quietMs / 2));
+}
+
+//==============================================================================
+void LibraryWatcher::run()
+{
+   #if JUCE_LINUX
+    alignas(struct inotify_event) char buffer[16384];
+
+    while (!threadShouldExit())
+    {
+        StringArray folders;
+        {
+            const ScopedLock sl(lock);
+            folders.swapWith(foldersToWalk);
+        }
+        for (const auto& folder : folders)
+            addWatches(File(folder));
+
+        pollfd descriptor{ inotifyFd, POLLIN, 0 };
+        if (poll(&descriptor, 1, 100) <= 0)
+            continue;
+
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                //events were lost, the roots are imported again and the importer skips what
+                //it knows; they are walked again too, for folders created meanwhile
+                std::cout << "LibraryWatcher::run - event queue overflowed" << std::endl;
+                const ScopedLock sl(lock);
+                for (const auto& root : roots)
+                {
+                    fileChanged(root.toStdString());
+                    lostRoots.addIfNotAlreadyThere(root);
+                    foldersToWalk.addIfNotAlreadyThere(root);
+                }
+                continue;
+            }
+
+            std::string path;
+            {
+                const ScopedLock sl(lock);
+                auto folder = folderByWatch.find(event->wd);
+                if (folder == folderByWatch.end())
+                    continue;
+
+                if (event->mask & IN_IGNORED)
+                {
+                    folderByWatch.erase(folder);
+                    continue;
+                }
+
+                if (event->len == 0)
+                    continue;
+                path = folder->second + File::getSeparatorString().toStdString() + event->name;
+            }
+
+            bool isFolder = (event->mask & IN_ISDIR) != 0;
+            if (isFolder && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                addWatches(File(path));
+
+            const ScopedLock sl(lock);
+            //a new file is taken once it is closed, not while it is still being copied
+            if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) || (isFolder && (event->mask & IN_CREATE)))
+                fileChanged(path);
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                fileRemoved(path);
+        }
+    }
+   #endif
+}
+
+void LibraryWatcher::timerCallback()
+{
+    StringArray changed, removed, lost;
+    {
+        const ScopedLock sl(lock);
+        if (changedPaths.empty() && removedPaths.empty())
+            return;
+
+        uint32 now = Time::getMillisecondCounter();
+        if (now - lastEventMs < quietMs && now - firstEventMs < maxDelayMs)
+            return;
+
+        for (const auto& path : changedPaths)
+            changed.add(path);
+        for (const auto& path : removedPaths)
+            removed.add(path);
+        changedPaths.clear();
+        removedPaths.clear();
+        lost.swapWith(lostRoots);
+    }
+
+    std::cout << "LibraryWatcher::timerCallback - " << changed.size() << " changed, "
+              << removed.size() << " removed" << std::endl;
+
+    if (onFilesChanged != nullptr)
+        onFilesChanged(changed, removed);
+
+    if (!lost.isEmpty() && onEventsLost != nullptr)
+        onEventsLost(lost);
+}
+
+void LibraryWatcher::addWatches(const File& folder)
+{
+   #if JUCE_LINUX
+    auto addWatch = [this](const File& dir)
+    {
+        const uint32_t mask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE | IN_ONLYDIR;
+        int watch = inotify_add_watch(inotifyFd, dir.getFullPathName().toRawUTF8(), mask);
+        if (watch < 0)
+        {
+            //usually fs.inotify.max_user_watches
+            std::cout << "LibraryWatcher::addWatches - can't watch " << dir.getFullPathName() << std::endl;
+            return;
+        }
+
+        const ScopedLock sl(lock);
+        folderByWatch[watch] = dir.getFullPathName().toStdString();
+    };
+
+    addWatch(folder);
+    for (const auto& entry : RangedDirectoryIterator(folder, true, "*", File::findDirectories))
+        addWatch(entry.getFile());
+   #else
+    ignoreUnused(folder);
+   #endif
+}
+
+void LibraryWatcher::fileChanged(const std::string& path)
+{
+    //a file saved by writing a copy and renaming it over is removed and changed
+    removedPaths.erase(path);
+    changedPaths.insert(path);
+
+    lastEventMs = Time::getMillisecondCounter();
+    if (changedPaths.size() + removedPaths.size() == 1)
+        firstEventMs = lastEventMs;
+}
+
+void LibraryWatcher::fileRemoved(const std::string& path)
+{
+    changedPaths.erase(path);
+    removedPaths.insert(path);
+
+    lastEventMs = Time::getMillisecondCounter();
+    if (changedPaths.size() + removedPaths.size() == 1)
+        firstEventMs = lastEventMs;
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    LibraryWatcher.h
+    Created: 20 Oct 2026 12:37:45am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+
+/** Watches the library folders for files being added, saved, moved and
+    deleted, so the library follows the folders without rescanning them.
+
+    On Linux a background thread reads inotify events for every folder below
+    the watched ones. Events are collected until the folders have been quiet
+    for a moment and then handed to the message thread together, a folder
+    being copied in arrives as one batch. Other platforms don't watch. **/
+class LibraryWatcher : private Thread,
+                       private Timer
+{
+public:
+    /** Called on the message thread. changed holds files written or moved in
+    and folders created or moved in, removed the files and folders deleted or
+    moved out **/
+    std::function<void(const StringArray& changed, const StringArray& removed)> onFilesChanged;
+
+    /** Called on the message thread, after onFilesChanged, when events were lost.
+    The roots were also passed as changed so they are imported again, but what
+    was deleted from them is up to the caller to find **/
+    std::function<void(const StringArray& roots)> onEventsLost;
+
+    LibraryWatcher();
+    ~LibraryWatcher() override;
+
+    /** Watch the folder and every folder below it. The folders below are walked
+    on the watcher thread, not here **/
+    void watch(const File& folder);
+
+private:
+    void run() override;
+    void timerCallback() override;
+
+    /** Watch a folder and the folders below it, on the watcher thread **/
+    void addWatches(const File& folder);
+
+    void fileChanged(const std::string& path);
+    void fileRemoved(const std::string& path);
+
+    int inotifyFd = -1;
+
+    CriticalSection lock;
+    std::map<int, std::string> folderByWatch;
+    StringArray roots;
+
+    //roots queued by watch or by a lost event, walked by the thread
+    StringArray foldersToWalk;
+
+    //roots whose events were lost since the last batch
+    StringArray lostRoots;
+
+    //paths since the last batch, a path only ever in one of the two
+    std::set<std::string> changedPaths;
+    std::set<std::string> removedPaths;
+    uint32 lastEventMs = 0;
+    uint32 firstEventMs = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LibraryWatcher)
+};
@@ -0,0 +1,293 @@
+/*
+  ==============================================================================
+
+    LoopingAudioSource.cpp
+    Created: 19 Oct 2026 1:18:26pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LoopingAudioSource.h"
+
+std::shared_ptr<const DecodedWindow> DecodedWindow::decode(AudioFormatReader& reader, int64 start, int64 length)
+{
+    start = jlimit<int64>(0, reader.lengthInSamples, start);
+    length = jmin(length, reader.lengthInSamples - start);
+    if (length <= 0 || reader.numChannels == 0)
+        return nullptr;
+
+    const int numChannels = jmin(2, static_cast<int>(reader.numChannels));
+    auto window = std::make_shared<DecodedWindow>();
+    window->startSample = start;
+    window->samples.setSize(numChannels, static_cast<int>(length));
+    reader.read(&window->samples, 0, static_cast<int>(length), start, true, numChannels > 1);
+    return window;
+}
+
+//==============================================================================
+void LoopingAudioSource::setSource(PositionableAudioSource* newSource)
+{
+    //windows of the previous track are released after the lock
+    WindowPtr oldLoop, oldPendingLoop, oldCue, oldNextCue, oldJump;
+    {
+        const SpinLock::ScopedLockType sl(lock);
+        source = newSource;
+        std::swap(oldLoop, loopWindow);
+        std::swap(oldPendingLoop, pendingLoop);
+        std::swap(oldCue, cueWindow);
+        std::swap(oldNextCue, nextCue);
+        std::swap(oldJump, pendingJump);
+        loopChanged = false;
+        loopActive = false;
+        jumpRequested = false;
+        position = 0;
+        pendingSeek = -1;
+        wrapFadePosition = crossfadeLength;
+    }
+}
+
+void LoopingAudioSource::setLoop(WindowPtr window, int64 newLoopStart, int64 newLoopEnd)
+{
+    if (window == nullptr || newLoopStart < window->startSample
+        || newLoopEnd <= newLoopStart || newLoopEnd > window->getEndSample())
+    {
+        std::cout << "LoopingAudioSource::setLoop loop should be inside the window" << std::endl;
+        return;
+    }
+
+    {
+        const SpinLock::ScopedLockType sl(lock);
+        std::swap(pendingLoop, window);
+        pendingLoopStart = newLoopStart;
+        pendingLoopEnd = newLoopEnd;
+        loopChanged = true;
+        loopActive = true;
+    }
+    //window now holds an unplayed loop or the one the audio thread left behind,
+    //released here on the calling thread
+}
+
+void LoopingAudioSource::clearLoop()
+{
+    //the window stays, so playback runs on past the loop end without seeking
+    loopActive = false;
+}
+
+void LoopingAudioSource::jumpTo(WindowPtr window, int64 startPosition)
+{
+    if (window == nullptr || !window->contains(startPosition))
+        return;
+
+    {
+        const SpinLock::ScopedLockType sl(lock);
+        std::swap(pendingJump, window);
+        pendingJumpPosition = startPosition;
+        jumpRequested = true;
+    }
+    //window now holds an unplayed jump or the window the audio thread left behind
+}
+
+//==============================================================================
+void LoopingAudioSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    fadeBuffer.setSize(2, crossfadeLength);
+
+    if (source != nullptr)
+        source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void LoopingAudioSource::releaseResources()
+{
+    if (source != nullptr)
+        source->releaseResources();
+}
+
+void LoopingAudioSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    if (source == nullptr)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    AudioBuffer<float>& buffer = *bufferToFill.buffer;
+    int64 pos = position;
+
+    int64 seek = pendingSeek.exchange(-1);
+    if (seek >= 0)
+    {
+        pos = seek;
+        wrapFadePosition = crossfadeLength;
+    }
+
+    //the lock is let go before anything is read, the source may block on the file
+    int jumpFadeLength = 0;
+    int64 jumpPosition = 0;
+    if (pickUpPending(jumpPosition))
+    {
+        //what would have played, faded out under the start of the new window
+        jumpFadeLength = jmin(crossfadeLength, bufferToFill.numSamples, fadeBuffer.getNumSamples());
+        readStraight(pos, fadeBuffer, 0, jumpFadeLength);
+
+        std::swap(cueWindow, nextCue);
+        pos = jumpPosition;
+        wrapFadePosition = crossfadeLength;
+    }
+
+    int done = 0;
+    while (done < bufferToFill.numSamples)
+    {
+        int numSamples = bufferToFill.numSamples - done;
+        bool inLoop = loopActive && loopWindow != nullptr && pos >= loopStart && pos < loopEnd;
+        if (inLoop)
+            numSamples = static_cast<int>(jmin<int64>(numSamples, loopEnd - pos));
+
+        readStraight(pos, buffer, bufferToFill.startSample + done, numSamples);
+        applyWrapCrossfade(buffer, bufferToFill.startSample + done, numSamples);
+
+        pos += numSamples;
+        done += numSamples;
+
+        //sample-accurate wrap, the crossfade runs over the first samples of the next pass
+        if (inLoop && pos >= loopEnd)
+        {
+            pos = loopStart;
+            wrapFadePosition = 0;
+        }
+    }
+
+    if (jumpFadeLength > 0)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            float* out = buffer.getWritePointer(channel, bufferToFill.startSample);
+            const float* old = fadeBuffer.getReadPointer(jmin(channel, fadeBuffer.getNumChannels() - 1));
+            for (int i = 0; i < jumpFadeLength; ++i)
+            {
+                float gain = (i + 0.5f) / jumpFadeLength;
+                out[i] = out[i] * gain + old[i] * (1.0f - gain);
+            }
+        }
+    }
+
+    position = pos;
+}
+
+bool LoopingAudioSource::pickUpPending(int64& jumpPosition)
+{
+    const SpinLock::ScopedTryLockType sl(lock);
+    if (!sl.isLocked())
+        return false;
+
+    if (loopChanged)
+    {
+        std::swap(loopWindow, pendingLoop);
+        loopStart = pendingLoopStart;
+        loopEnd = pendingLoopEnd;
+        loopChanged = false;
+    }
+
+    //the new window waits in nextCue until the fade out of the old one is read
+    if (jumpRequested && pendingJump != nullptr)
+    {
+        std::swap(nextCue, pendingJump);
+        jumpPosition = pendingJumpPosition;
+        jumpRequested = false;
+        return true;
+    }
+    return false;
+}
+
+void LoopingAudioSource::setNextReadPosition(int64 newPosition)
+{
+    //applied by the audio thread at the start of its next block
+    pendingSeek = newPosition;
+    position = newPosition;
+}
+
+int64 LoopingAudioSource::getNextReadPosition() const
+{
+    //a jump lands after a seek in the same block
+    if (jumpRequested)
+        return pendingJumpPosition;
+
+    int64 seek = pendingSeek;
+    return seek >= 0 ? seek : position.load();
+}
+
+int64 LoopingAudioSource::getTotalLength() const
+{
+    return source != nullptr ? source->getTotalLength() : 0;
+}
+
+//==============================================================================
+void LoopingAudioSource::readStraight(int64 pos, AudioBuffer<float>& dest, int destStart, int numSamples)
+{
+    while (numSamples > 0)
+    {
+        const DecodedWindow* window = findWindow(pos);
+        if (window == nullptr)
+        {
+            //outside every window: the only place the reader is touched, and it
+            //only seeks when playback didn't come straight from where it stopped
+            if (source->getNextReadPosition() != pos)
+                source->setNextReadPosition(pos);
+
+            AudioSourceChannelInfo info(&dest, destStart, numSamples);
+            source->getNextAudioBlock(info);
+            return;
+        }
+
+        int num = static_cast<int>(jmin<int64>(numSamples, window->getEndSample() - pos));
+        int offset = static_cast<int>(pos - window->startSample);
+        const int windowChannels = window->samples.getNumChannels();
+
+        for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+        {
+            dest.copyFrom(channel, destStart, window->samples, jmin(channel, windowChannels - 1), offset, num);
+        }
+
+        pos += num;
+        destStart += num;
+        numSamples -= num;
+    }
+}
+
+void LoopingAudioSource::applyWrapCrossfade(AudioBuffer<float>& dest, int destStart, int numSamples)
+{
+    if (wrapFadePosition >= crossfadeLength || loopWindow == nullptr)
+        return;
+
+    int count = jmin(numSamples, crossfadeLength - wrapFadePosition);
+    int64 tailStart = loopEnd - loopWindow->startSample + wrapFadePosition;
+    int available = static_cast<int>(jmin<int64>(count, loopWindow->samples.getNumSamples() - tailStart));
+    const int windowChannels = loopWindow->samples.getNumChannels();
+
+    for (int channel = 0; channel < dest.getNumChannels() && available > 0; ++channel)
+    {
+        //the samples right after the loop end fade out while the loop start fades in
+        const float* tail = loopWindow->samples.getReadPointer(jmin(channel, windowChannels - 1),
+                                                               static_cast<int>(tailStart));
+        float* out = dest.getWritePointer(channel, destStart);
+        for (int i = 0; i < available; ++i)
+        {
+            float gain = (wrapFadePosition + i + 0.5f) / crossfadeLength;
+            out[i] = out[i] * gain + tail[i] * (1.0f - gain);
+        }
+    }
+
+    wrapFadePosition += count;
+}
+
+const DecodedWindow* LoopingAudioSource::findWindow(int64 pos) const
+{
+    if (loopWindow != nullptr && loopWindow->contains(pos))
+        return loopWindow.get();
+
+    if (cueWindow != nullptr && cueWindow->contains(pos))
+        return cueWindow.get();
+
+    return nullptr;
+}
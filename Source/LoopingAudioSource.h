@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    LoopingAudioSource.h
+    Created: 19 Oct 2026 1:18:26pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+/** Stretch of a track decoded into RAM, used for loops and hot cues **/
+struct DecodedWindow
+{
+    int64 startSample = 0;
+    AudioBuffer<float> samples;
+
+    int64 getEndSample() const { return startSample + samples.getNumSamples(); }
+    bool contains(int64 samplePos) const { return samplePos >= startSample && samplePos < getEndSample(); }
+
+    /** Decode length samples from start, returns nullptr if nothing could be read.
+    Blocking, never call it from the audio thread **/
+    static std::shared_ptr<const DecodedWindow> decode(AudioFormatReader& reader, int64 start, int64 length);
+};
+
+/** Sits between the file reader and the transport. Loops and jumps to hot cues
+    are served from decoded windows, so they never seek the reader: the loop
+    wraps sample-accurately inside its window and a jump (to a hot cue or a
+    prefetched seek target) just starts reading another window. Both are
+    crossfaded over a few samples to avoid clicks.
+
+    Windows are handed over from the message thread under a spin lock. The audio
+    thread only try-locks it at the start of a block to pick them up, and renders
+    with no lock held; what it misses is picked up on the next block. Windows are
+    always released on the message thread. **/
+class LoopingAudioSource : public PositionableAudioSource
+{
+public:
+    using WindowPtr = std::shared_ptr<const DecodedWindow>;
+
+    /** Length of the loop and jump crossfades in samples **/
+    static constexpr int crossfadeLength = 64;
+
+    LoopingAudioSource() = default;
+    ~LoopingAudioSource() override = default;
+
+    /** Source to read outside the windows, not owned. Detach the transport first **/
+    void setSource(PositionableAudioSource* newSource);
+
+    /** Loop [loopStart, loopEnd). The window has to start at or before loopStart
+    and reach crossfadeLength samples past loopEnd for the wrap crossfade **/
+    void setLoop(WindowPtr window, int64 loopStart, int64 loopEnd);
+    void clearLoop();
+    bool isLoopActive() const { return loopActive.load(); }
+
+    /** Continue playing from startPosition, inside the window, on the next block **/
+    void jumpTo(WindowPtr window, int64 startPosition);
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override;
+    bool isLooping() const override { return false; }
+
+private:
+    /** Read without wrapping, from a window when one holds the samples, else from the source **/
+    void readStraight(int64 pos, AudioBuffer<float>& dest, int destStart, int numSamples);
+
+    /** Blend the material past the loop end into the first samples after a wrap **/
+    void applyWrapCrossfade(AudioBuffer<float>& dest, int destStart, int numSamples);
+
+    const DecodedWindow* findWindow(int64 pos) const;
+
+    /** Take the loop and jump handed over since the last block, if the lock is free.
+    Returns true when a jump was picked up, with where it lands. Audio thread only **/
+    bool pickUpPending(int64& jumpPosition);
+
+    //set with the transport detached, so never while a block is rendered
+    PositionableAudioSource* source = nullptr;
+
+    //handed over by the message thread, the audio thread swaps them with its own
+    //so the windows it drops are left here for the message thread to free
+    SpinLock lock;
+    WindowPtr pendingLoop;
+    int64 pendingLoopStart = 0;
+    int64 pendingLoopEnd = 0;
+    bool loopChanged = false;
+    WindowPtr pendingJump;
+    std::atomic<int64> pendingJumpPosition{ 0 };
+    std::atomic<bool> jumpRequested{ false };
+    std::atomic<bool> loopActive{ false };
+
+    //only used by the audio thread, and by setSource while it is detached
+    WindowPtr loopWindow;
+    int64 loopStart = 0;
+    int64 loopEnd = 0;
+    WindowPtr cueWindow;
+    WindowPtr nextCue;
+
+    std::atomic<int64> position{ 0 };
+    std::atomic<int64> pendingSeek{ -1 };
+    int wrapFadePosition = crossfadeLength;
+
+    AudioBuffer<float> fadeBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LoopingAudioSource)
+};
@@ -11,7 +11,7 @@
 
 //==============================================================================
 MainComponent::MainComponent()
-	: playlistComponent(deckGUI1, deckGUI2)
+	: playlistComponent(deckGUI1, deckGUI2, trackAnalyser, formatManager, autoDJ, previewPlayer)
 {
     // Make sure you set the size of the component after
     // you add any child components.
@@ -22,18 +22,24 @@ MainComponent::MainComponent()
         && ! RuntimePermissions::isGranted (RuntimePermissions::recordAudio))
     {
         RuntimePermissions::request (RuntimePermissions::recordAudio,
-                                     [&] (bool granted) { if (granted)  setAudioChannels (2, 2); });
+                                     [&] (bool granted) { if (granted)  setAudioChannels (2, 4); });
     }  
     else
     {
-        // Specify the number of input and output channels that we want to open
-        setAudioChannels (0, 2);
+        // Specify the number of input and output channels that we want to open,
+        // outputs 3 and 4 are the cue output on devices that have them
+        setAudioChannels (0, 4);
     }  
 
     addAndMakeVisible(deckGUI1); 
     addAndMakeVisible(deckGUI2);  
+    addAndMakeVisible(masterMeterDisplay);
 
     addAndMakeVisible(playlistComponent);
+    addChildComponent(profilerOverlay);
+    setWantsKeyboardFocus(true);
+
+    uiScheduler.addClient(this);
 
 
     formatManager.registerBasicFormats();
@@ -43,6 +49,8 @@ MainComponent::~MainComponent()
 {
     // This shuts down the audio device and clears the audio source.
     shutdownAudio();
+    uiScheduler.removeClient(this);
+    profilerOverlay.setActive(false);
 }
 
 //==============================================================================
@@ -57,10 +65,65 @@ void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRat
     mixerSource.addInputSource(&player1, false);
     mixerSource.addInputSource(&player2, false);
 
+    previewPlayer.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    //the callback only takes views of it, a longer block is rendered in slices
+    previewBuffer.setSize(2, samplesPerBlockExpected);
+
+    masterMeter.prepare(sampleRate);
+
  }
 void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    //Tempo sync runs before the decks render, with both decks synced deck 1 leads
+    player2.followTempo(player1, bufferToFill.numSamples);
+    if (!player2.isSyncEnabled())
+        player1.followTempo(player2, bufferToFill.numSamples);
+
+    //The decks are stereo, channels past the first two are the cue output
+    AudioBuffer<float>& output = *bufferToFill.buffer;
+    int numMasterChannels = jmin(2, output.getNumChannels());
+    AudioBuffer<float> master(output.getArrayOfWritePointers(), numMasterChannels,
+                              bufferToFill.startSample, bufferToFill.numSamples);
+    AudioSourceChannelInfo masterInfo(master);
+    mixerSource.getNextAudioBlock(masterInfo);
+    for (int channel = numMasterChannels; channel < output.getNumChannels(); ++channel)
+        output.clear(channel, bufferToFill.startSample, bufferToFill.numSamples);
+
+    //Nothing to render while no track is auditioned
+    if (previewPlayer.isActive() && previewBuffer.getNumSamples() > 0)
+    {
+        for (int done = 0; done < bufferToFill.numSamples; )
+        {
+            int numSamples = jmin(bufferToFill.numSamples - done, previewBuffer.getNumSamples());
+            int startSample = bufferToFill.startSample + done;
+            AudioBuffer<float> preview(previewBuffer.getArrayOfWritePointers(), 2, numSamples);
+            AudioSourceChannelInfo previewInfo(preview);
+            previewPlayer.getNextAudioBlock(previewInfo);
+
+            if (output.getNumChannels() >= 4)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                    output.copyFrom(channel + 2, startSample, preview, channel, 0, numSamples);
+            }
+            else
+            {
+                for (int channel = 0; channel < numMasterChannels; ++channel)
+                    output.addFrom(channel, startSample, preview, channel, 0, numSamples, previewMixGain);
+            }
+            done += numSamples;
+        }
+    }
+
+    //What goes out of the master, the preview included when it plays under the mix
+    masterMeter.process(master, 0, bufferToFill.numSamples);
+
+    //What the GUI shows of this block, it picks it up on its next frame
+    UIFrame frame;
+    frame.numDecks = 2;
+    frame.decks[0] = player1.getDeckState();
+    frame.decks[1] = player2.getDeckState();
+    frame.master = masterMeter.getLevels();
+    uiFrames.write(frame);
 }
 
 void MainComponent::releaseResources()
@@ -72,6 +135,7 @@ void MainComponent::releaseResources()
     player1.releaseResources();
     player2.releaseResources();
     mixerSource.releaseResources();
+    previewPlayer.releaseResources();
 }
 
 //==============================================================================
@@ -81,15 +145,51 @@ void MainComponent::paint (Graphics& g)
     g.fillAll (juce::Colour(0xFF2E2E2E).withAlpha(0.6f));
 
     // You can add your drawing code here!
+    if (!firstPaintLogged)
+    {
+        firstPaintLogged = true;
+        Utilities::logStartupPhase("window shown");
+    }
 }
 
 void MainComponent::resized()
 {
-    deckGUI1.setBounds(0, 0, getWidth()/2, getHeight() / 2);
-    deckGUI2.setBounds(getWidth()/2, 0, getWidth()/2, getHeight() / 2);
+    int deckWidth = (getWidth() - masterMeterWidth) / 2;
+    deckGUI1.setBounds(0, 0, deckWidth, getHeight() / 2);
+    masterMeterDisplay.setBounds(deckWidth, 0, masterMeterWidth, getHeight() / 2);
+    deckGUI2.setBounds(deckWidth + masterMeterWidth, 0, getWidth() - deckWidth - masterMeterWidth, getHeight() / 2);
 
     playlistComponent.setBounds(0, getHeight() / 2, getWidth(), getHeight() / 2);
 
+    profilerOverlay.setBounds(getWidth() - 470, 10, 460, 280);
+
+}
+
+bool MainComponent::keyPressed(const KeyPress& key)
+{
+    if (key.getKeyCode() != KeyPress::F12Key)
+        return false;
+
+    if (key.getModifiers().isShiftDown())
+    {
+        //next to the library, like the rest of the app's files
+        File profileFile = File::getSpecialLocation(File::currentApplicationFile).getParentDirectory()
+            .getChildFile("dataFiles")
+            .getChildFile("paint-profile-" + Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".csv");
+        PaintProfiler::getInstance().exportCSV(profileFile);
+    }
+    else
+    {
+        profilerOverlay.setActive(!profilerOverlay.isActive());
+    }
+    return true;
+}
+
+void MainComponent::refresh(const UIFrame& frame)
+{
+    deckGUI1.refresh(frame.decks[0]);
+    deckGUI2.refresh(frame.decks[1]);
+    masterMeterDisplay.setLevels(frame.master);
 }
 
 DeckGUI* MainComponent::getDeckGUI(int deckNum)
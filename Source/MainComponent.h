@@ -12,6 +12,15 @@
 #include "DJAudioPlayer.h"
 #include "DeckGUI.h"
 #include "PlaylistComponent.h"
+#include "AutoDJ.h"
+#include "PreviewPlayer.h"
+#include "TrackAnalyser.h"
+#include "DecodedBlockCache.h"
+#include "WaveformCache.h"
+#include "ProfilerOverlay.h"
+#include "LevelMeter.h"
+#include "LevelMeterDisplay.h"
+#include "UIRefreshScheduler.h"
 #include "../Thirdparty/nlohmann/json.hpp"
 
 //==============================================================================
@@ -19,7 +28,8 @@
     This component lives inside our window, and this is where you should put all
     your controls and content.
 */
-class MainComponent   : public AudioAppComponent
+class MainComponent   : public AudioAppComponent,
+                        private UIRefreshScheduler::Client
 {
 public:
     //==============================================================================
@@ -35,26 +45,60 @@ public:
     void paint (Graphics& g) override;
     void resized() override;
 
+    /** F12 shows the paint profiler, shift+F12 exports what it recorded **/
+    bool keyPressed(const KeyPress& key) override;
+
     /** Function to expose the Decks to allow tracks loaded from playlist **/
 	DeckGUI* getDeckGUI(int deckNum);
 
 
 private:
+    /** Hand each deck its part of the frame **/
+    void refresh(const UIFrame& frame) override;
+
     //==============================================================================
     // Your private member variables go here...
      
     AudioFormatManager formatManager;
     AudioThumbnailCache thumbCache{100}; 
+    //decoded audio shared by the decks, the waveforms and the analysis
+    DecodedBlockCache blockCache{formatManager};
+    TrackAnalyser trackAnalyser{blockCache};
+    //close-up waveform tiles, a track on both decks is computed once
+    WaveformCache waveformCache{blockCache};
 
-    DJAudioPlayer player1{formatManager};
-    DeckGUI deckGUI1{&player1, formatManager, thumbCache}; 
+    DJAudioPlayer player1{formatManager, blockCache};
+    DeckGUI deckGUI1{&player1, formatManager, thumbCache, blockCache, waveformCache, trackAnalyser}; 
 
-    DJAudioPlayer player2{formatManager};
-    DeckGUI deckGUI2{&player2, formatManager, thumbCache}; 
+    DJAudioPlayer player2{formatManager, blockCache};
+    DeckGUI deckGUI2{&player2, formatManager, thumbCache, blockCache, waveformCache, trackAnalyser}; 
 
     MixerAudioSource mixerSource; 
 
+    //plays a crate through both decks, preparing the next tracks ahead
+    AutoDJ autoDJ{deckGUI1, deckGUI2, formatManager, thumbCache, blockCache, trackAnalyser};
+
+    //auditions playlist tracks on the cue output, channels 3 and 4, or under the mix
+    PreviewPlayer previewPlayer{formatManager, blockCache};
+    AudioBuffer<float> previewBuffer;
+    static constexpr float previewMixGain = 0.25f;
+
+    //the master output, between the decks
+    LevelMeter masterMeter;
+    LevelMeterDisplay masterMeterDisplay;
+    static constexpr int masterMeterWidth = 24;
+
     PlaylistComponent playlistComponent;
+
+    //paint times and message thread stalls, hidden until F12
+    ProfilerOverlay profilerOverlay;
+
+    //written by the audio thread every block, read once per frame by the scheduler
+    SeqLock<UIFrame> uiFrames;
+    UIRefreshScheduler uiScheduler{uiFrames, *this};
+
+    //the first paint is logged as the window being shown
+    bool firstPaintLogged = false;
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    PaintProfiler.cpp
+    Created: 20 Oct 2026 5:06:12am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PaintProfiler.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    //the heartbeat runs this often while profiling
+    constexpr int heartbeatMs = 10;
+
+    //a heartbeat this much later than due is a stall, timers jitter below it
+    constexpr double stallThresholdMs = 25.0;
+
+    const char* getKindName(PaintProfiler::Kind kind)
+    {
+        switch (kind)
+        {
+            case PaintProfiler::Kind::paint:    return "paint";
+            case PaintProfiler::Kind::call:     return "call";
+            case PaintProfiler::Kind::timerLag: return "timer lag";
+            case PaintProfiler::Kind::stall:    return "stall";
+        }
+        return "";
+    }
+}
+
+PaintProfiler& PaintProfiler::getInstance()
+{
+    static PaintProfiler instance;
+    return instance;
+}
+
+void PaintProfiler::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == enabled)
+        return;
+
+    enabled = shouldBeEnabled;
+    if (enabled)
+    {
+        //allocated once, recording never allocates
+        events.resize(capacity);
+        lastHeartbeatMs = Time::getMillisecondCounterHiRes();
+        startTimer(heartbeatMs);
+    }
+    else
+    {
+        stopTimer();
+    }
+    std::cout << "PaintProfiler::setEnabled - " << (enabled ? "on" : "off") << std::endl;
+}
+
+//==============================================================================
+PaintProfiler::Scope::Scope(const char* _name, Kind _kind)
+    : name(_name), kind(_kind)
+{
+    if (getInstance().isEnabled())
+        startMs = Time::getMillisecondCounterHiRes();
+}
+
+PaintProfiler::Scope::~Scope()
+{
+    if (startMs >= 0.0)
+        getInstance().record(name, kind, startMs, Time::getMillisecondCounterHiRes() - startMs);
+}
+
+void PaintProfiler::TimerProbe::beat()
+{
+    auto& profiler = getInstance();
+    double now = Time::getMillisecondCounterHiRes();
+    if (profiler.isEnabled() && lastMs >= 0.0)
+        profiler.record(name, Kind::timerLag, lastMs + intervalMs, jmax(0.0, now - lastMs - intervalMs));
+    lastMs = now;
+}
+
+//==============================================================================
+void PaintProfiler::record(const char* name, Kind kind, double startMs, double durationMs)
+{
+    if (!enabled)
+        return;
+
+    events[nextEvent] = { name, kind, startMs, static_cast<float>(durationMs) };
+    if (++nextEvent == capacity)
+    {
+        nextEvent = 0;
+        wrapped = true;
+    }
+}
+
+std::vector<PaintProfiler::Summary> PaintProfiler::summarise(double windowMs) const
+{
+    std::vector<Summary> summaries;
+    size_t numEvents = wrapped ? capacity : nextEvent;
+    double since = Time::getMillisecondCounterHiRes() - windowMs;
+
+    for (size_t i = 0; i < numEvents; ++i)
+    {
+        const Event& event = events[i];
+        if (event.startMs < since)
+            continue;
+
+        //the same literal can have a different address in each file
+        auto summary = std::find_if(summaries.begin(), summaries.end(), [&event](const Summary& s)
+        {
+            return s.kind == event.kind && (s.name == event.name || std::strcmp(s.name, event.name) == 0);
+        });
+        if (summary == summaries.end())
+            summary = summaries.insert(summaries.end(), { event.name, event.kind, 0, 0.0, 0.0 });
+
+        ++summary->count;
+        summary->meanMs += event.durationMs;
+        summary->maxMs = jmax(summary->maxMs, static_cast<double>(event.durationMs));
+    }
+
+    for (auto& summary : summaries)
+        summary.meanMs /= summary.count;
+    return summaries;
+}
+
+bool PaintProfiler::exportCSV(const File& file) const
+{
+    FileOutputStream out(file);
+    if (out.failedToOpen())
+    {
+        std::cout << "PaintProfiler::exportCSV - can't write " << file.getFullPathName() << std::endl;
+        return false;
+    }
+    out.setPosition(0);
+    out.truncate();
+
+    out << "kind,name,start_ms,duration_ms\n";
+    size_t numEvents = wrapped ? capacity : nextEvent;
+    size_t first = wrapped ? nextEvent : 0;
+    for (size_t i = 0; i < numEvents; ++i)
+    {
+        const Event& event = events[(first + i) % capacity];
+        out << getKindName(event.kind) << "," << event.name << ","
+            << String(event.startMs, 3) << "," << String(event.durationMs, 3) << "\n";
+    }
+
+    out.flush();
+    std::cout << "PaintProfiler::exportCSV - " << static_cast<int>(numEvents) << " events to "
+              << file.getFullPathName() << std::endl;
+    return out.getStatus().wasOk();
+}
+
+void PaintProfiler::timerCallback()
+{
+    double now = Time::getMillisecondCounterHiRes();
+    double late = now - lastHeartbeatMs - heartbeatMs;
+    if (late > stallThresholdMs)
+        record("message thread", Kind::stall, lastHeartbeatMs + heartbeatMs, late);
+    lastHeartbeatMs = now;
+}
+
+//==============================================================================
+void ProfilingLookAndFeel::drawLinearSlider(Graphics& g, int x, int y, int width, int height,
+                                            float sliderPos, float minSliderPos, float maxSliderPos,
+                                            const Slider::SliderStyle style, Slider& slider)
+{
+    PaintProfiler::Scope scope("Slider::drawLinearSlider");
+    LookAndFeel_V4::drawLinearSlider(g, x, y, width, height, sliderPos, minSliderPos, maxSliderPos, style, slider);
+}
+
+void ProfilingLookAndFeel::drawRotarySlider(Graphics& g, int x, int y, int width, int height,
+                                            float sliderPosProportional, float rotaryStartAngle,
+                                            float rotaryEndAngle, Slider& slider)
+{
+    PaintProfiler::Scope scope("Slider::drawRotarySlider");
+    LookAndFeel_V4::drawRotarySlider(g, x, y, width, height, sliderPosProportional,
+                                     rotaryStartAngle, rotaryEndAngle, slider);
+}
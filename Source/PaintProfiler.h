@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    PaintProfiler.h
+    Created: 20 Oct 2026 5:06:12am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/** Records where the message thread's time goes: how long each component
+    paints, how long load calls take, how late timers fire and when the
+    message thread stops answering at all. Events go in a fixed ring buffer,
+    summarised by the ProfilerOverlay and exported as CSV to track down jank.
+
+    Off by default, a disabled scope is a flag check. Message thread only,
+    like everything it measures. **/
+class PaintProfiler : private Timer
+{
+public:
+    enum class Kind
+    {
+        paint,      // a paint call, the count is the repaint rate
+        call,       // a blocking call such as loading a track
+        timerLag,   // how late a timer callback came
+        stall       // the message thread didn't run for this long
+    };
+
+    struct Event
+    {
+        //a string literal, never copied
+        const char* name;
+        Kind kind;
+        double startMs;
+        float durationMs;
+    };
+
+    struct Summary
+    {
+        const char* name;
+        Kind kind;
+        int count;
+        double meanMs;
+        double maxMs;
+    };
+
+    /** Events kept, about a minute of a busy window **/
+    static constexpr size_t capacity = 16384;
+
+    static PaintProfiler& getInstance();
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled; }
+
+    /** Times the scope it lives in, name must be a string literal **/
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name, Kind kind = Kind::paint);
+        ~Scope();
+
+    private:
+        const char* name;
+        Kind kind;
+        double startMs = -1.0;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+    /** Call at the top of a timer callback, records how much later than its
+    interval it came **/
+    class TimerProbe
+    {
+    public:
+        TimerProbe(const char* name, int intervalMs) : name(name), intervalMs(intervalMs) {}
+
+        void beat();
+
+    private:
+        const char* name;
+        int intervalMs;
+        double lastMs = -1.0;
+    };
+
+    void record(const char* name, Kind kind, double startMs, double durationMs);
+
+    /** Every name seen in the last windowMs with its count, mean and worst duration **/
+    std::vector<Summary> summarise(double windowMs) const;
+
+    /** Write the events in the ring buffer as CSV, oldest first **/
+    bool exportCSV(const File& file) const;
+
+private:
+    PaintProfiler() = default;
+    ~PaintProfiler() override = default;
+
+    /** Heartbeat, a late one is a stall of the message thread **/
+    void timerCallback() override;
+
+    bool enabled = false;
+
+    std::vector<Event> events;
+    size_t nextEvent = 0;
+    bool wrapped = false;
+
+    double lastHeartbeatMs = -1.0;
+
+    JUCE_DECLARE_NON_COPYABLE (PaintProfiler)
+};
+
+//==============================================================================
+/** Times the slider drawing of the components it is set on, under their
+    own names; draws like the default look and feel **/
+class ProfilingLookAndFeel : public LookAndFeel_V4
+{
+public:
+    void drawLinearSlider(Graphics& g, int x, int y, int width, int height,
+                          float sliderPos, float minSliderPos, float maxSliderPos,
+                          const Slider::SliderStyle style, Slider& slider) override;
+
+    void drawRotarySlider(Graphics& g, int x, int y, int width, int height, float sliderPosProportional,
+                          float rotaryStartAngle, float rotaryEndAngle, Slider& slider) override;
+};
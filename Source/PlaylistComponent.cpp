@@ -10,47 +10,40 @@
 
 #include <JuceHeader.h>
 #include "PlaylistComponent.h"
-#include <fstream>
+#include "PlaylistFile.h"
+#include "PaintProfiler.h"
+#include <algorithm>
 
 //==============================================================================
-PlaylistComponent::PlaylistComponent(DeckGUI& leftDeck, DeckGUI& rightDeck)
-	: leftDeck(leftDeck), rightDeck(rightDeck)
+PlaylistComponent::PlaylistComponent(DeckGUI& leftDeck, DeckGUI& rightDeck, TrackAnalyser& trackAnalyser,
+                                     AudioFormatManager& formatManager, AutoDJ& autoDJ, PreviewPlayer& previewPlayer)
+	: leftDeck(leftDeck), rightDeck(rightDeck), trackAnalyser(trackAnalyser), autoDJ(autoDJ),
+      previewPlayer(previewPlayer), importer(formatManager)
 {
-    // Read and parse the JSON file
-	//--Get the path to the dataFiles folder and the playlist file
+    //--Get the path to the dataFiles folder
     juce::File dataFilesFolder = juce::File::getSpecialLocation(juce::File::currentApplicationFile)
         .getParentDirectory().getChildFile("dataFiles");
-    juce::File playlistFile = dataFilesFolder.getChildFile("playlist.json");
 
     // Create the dataFiles folder if it doesn't exist
     if (!dataFilesFolder.exists())
         dataFilesFolder.createDirectory();
 
-	//--Read from JSON file
-    std::ifstream f(playlistFile.getFullPathName().toStdString());
-    if (f.is_open())
-    {
-        try
-        {
-			//Parse the JSON file
-            playlistInfoJSON = nlohmann::json::parse(f);
-			//Populate the track titles array
-            updateTrackTitles();
-        }
-        catch (const nlohmann::json::parse_error&)
-        {
-
-        }
-    }
-
 	//Code for table component
-    tableComponent.getHeader().addColumn("Track title", 1, 260);
+    //Clicking the header of a data column sorts by it
+    auto buttonColumn = TableHeaderComponent::notSortable;
+    tableComponent.getHeader().addColumn("Track title", 1, 220);
+    tableComponent.getHeader().addColumn("Artist", 8, 150);
     tableComponent.getHeader().addColumn("Duration", 2, 70);
-    tableComponent.getHeader().addColumn("Left Deck", 3, 150);
-    tableComponent.getHeader().addColumn("Right Deck", 4, 150);
-    tableComponent.getHeader().addColumn("Remove", 5, 80);
+    tableComponent.getHeader().addColumn("BPM", 6, 60);
+    tableComponent.getHeader().addColumn("Key", 9, 50);
+    tableComponent.getHeader().addColumn("Added", 7, 90);
+    tableComponent.getHeader().addColumn("Left Deck", 3, 150, 30, -1, buttonColumn);
+    tableComponent.getHeader().addColumn("Right Deck", 4, 150, 30, -1, buttonColumn);
+    tableComponent.getHeader().addColumn("Preview", 10, 80, 30, -1, buttonColumn);
+    tableComponent.getHeader().addColumn("Remove", 5, 80, 30, -1, buttonColumn);
 
     tableComponent.setModel(this);
+    tableComponent.setMultipleSelectionEnabled(true);
 
     addAndMakeVisible(tableComponent);
 
@@ -58,8 +51,86 @@ PlaylistComponent::PlaylistComponent(DeckGUI& leftDeck, DeckGUI& rightDeck)
     addAndMakeVisible(addTrackButton);
     addTrackButton.addListener(this);
 
-	//Register audio format
-	formatManager.registerBasicFormats();
+    //Export button writes the library as m3u8, pls or json
+    addAndMakeVisible(exportButton);
+    exportButton.addListener(this);
+
+    //Auto DJ button plays the rows shown, crossfading between the decks
+    autoDJButton.setClickingTogglesState(false);
+    addAndMakeVisible(autoDJButton);
+    autoDJButton.addListener(this);
+    autoDJ.onStopped = [this] { autoDJButton.setToggleState(false, dontSendNotification); };
+    autoDJ.onTrackAnalysed = [this](TrackTable::TrackId id, const BeatGrid& grid)
+    {
+        library.setBeatGrid(id, grid.toArray());
+    };
+
+    //Preview button of the row playing shows stop
+    previewPlayer.onChange = [this]
+    {
+        if (!previewPlayer.isPreviewing())
+            previewingTrack = -1;
+        tableComponent.repaint();
+    };
+
+    //Crates are listed once the library has loaded and they are resolved
+    crateSelector.onChange = [this] { crateSelected(); };
+    addAndMakeVisible(crateSelector);
+    updateCrateSelector();
+
+    //Every keystroke filters the rows through the search index
+    searchBox.setTextToShowWhenEmpty("Search", juce::Colours::grey);
+    searchBox.onTextChange = [this] { updateVisibleRows(); };
+    addAndMakeVisible(searchBox);
+    updateVisibleRows();
+
+    //Imported tracks arrive in batches, each batch is one journal write
+    addAndMakeVisible(importStatus);
+    importer.onTracksProbed = [this](const std::vector<TrackInfo>& tracks) { addTracks(tracks); };
+    importer.onProgress = [this](const LibraryImporter::Progress& progress)
+    {
+        if (progress.finished)
+            applyPendingRemovals();
+
+        if (progress.finished)
+            importStatus.setText("Added " + String(progress.numAdded) + " tracks, "
+                                 + String(progress.numSkipped) + " already in the playlist", dontSendNotification);
+        else
+            importStatus.setText("Importing " + String(progress.numProbed) + " / " + String(progress.numFound),
+                                 dontSendNotification);
+    };
+
+    //Tags arrive for the rows on screen, cached tags are shown straight from the table.
+    //Rows keep their place until the next search or sort even if a tag changes it
+    tagReader.onTagsRead = [this](const std::vector<std::pair<TrackTable::TrackId, TrackTags>>& tags)
+    {
+        library.beginBatch();
+        for (const auto& [id, trackTags] : tags)
+            library.setTags(id, trackTags);
+        library.endBatch();
+        tableComponent.repaint();
+    };
+
+    //Files changed in the imported folders are applied as they happen, not by rescanning
+    watcher.onFilesChanged = [this](const StringArray& changed, const StringArray& removed)
+    {
+        applyFolderChanges(changed, removed);
+    };
+    watcher.onEventsLost = [this](const StringArray& roots)
+    {
+        checkFoldersForRemovals(roots);
+    };
+    watchedFoldersFile = dataFilesFolder.getChildFile("watchedFolders.txt");
+
+	//--Map the library index and load it in the background, rows appear as it loads
+    library.onLoadProgress = [this](bool finished)
+    {
+        if (finished)
+            libraryLoaded();
+        else if (getRows().empty() || Time::getMillisecondCounterHiRes() - lastLoadUpdateMs >= loadUpdateIntervalMs)
+            updateVisibleRows();
+    };
+    library.open(dataFilesFolder);
 
 }
 
@@ -89,11 +160,26 @@ void PlaylistComponent::resized()
 	//Set bounds for add track button
 	addTrackButton.setBounds(150,1, 70, 25);
 
+    //Set bounds for export button
+    exportButton.setBounds(225, 1, 60, 25);
+
+    //Set bounds for auto DJ button
+    autoDJButton.setBounds(290, 1, 70, 25);
+
+    //Set bounds for the import progress
+    importStatus.setBounds(365, 1, 175, 25);
+
+    //Set bounds for the crate selector
+    crateSelector.setBounds(getWidth() - 360, 1, 150, 25);
+
+    //Set bounds for the search box
+    searchBox.setBounds(getWidth() - 205, 1, 200, 25);
+
 }
 
 int PlaylistComponent::getNumRows()
 {
-    return trackTitles.size();
+    return static_cast<int>(getRows().size());
 }
 
 void PlaylistComponent::paintRowBackground(juce::Graphics& g,
@@ -102,6 +188,22 @@ void PlaylistComponent::paintRowBackground(juce::Graphics& g,
     int height,
     bool rowIsSelected)
 {
+    //Only rows painted have their tags read, the rest wait until scrolled to
+    const std::vector<TrackTable::TrackId>& rows = getRows();
+    if (rowNumber < static_cast<int>(rows.size()))
+    {
+        if (!firstRowsLogged)
+        {
+            firstRowsLogged = true;
+            Utilities::logStartupPhase("first rows visible");
+        }
+
+        const TrackTable& table = library.getTable();
+        TrackTable::TrackId id = rows[rowNumber];
+        if (!table.areTagsRead(id))
+            tagReader.request(id, table.getPath(id));
+    }
+
     if(rowIsSelected)
 	{
 		g.fillAll(juce::Colour(0xFF1DB954).withAlpha(0.5f));
@@ -120,14 +222,25 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
     int height,
     bool rowIsSelected)
 {
-    if (rowNumber < trackTitles.size())
+    PaintProfiler::Scope profile("PlaylistComponent::paintCell");
+    const TrackTable& table = library.getTable();
+    const std::vector<TrackTable::TrackId>& rows = getRows();
+    if (rowNumber < static_cast<int>(rows.size()))
     {
-        std::string const &trackName = trackTitles[rowNumber];
-        std::string const &trackDuration = playlistInfoJSON[trackName]["Duration"];
+        //Only reads the preformatted columns, nothing is looked up or converted
+        TrackTable::TrackId id = rows[rowNumber];
 
         if (columnId == 1)
         {
-            g.drawText(trackName,
+            g.drawText(table.getTitleText(id),
+                2, 0,
+                width, height,
+                Justification::centredLeft, true);
+        }
+
+        if (columnId == 8)
+        {
+            g.drawText(table.getArtistText(id),
                 2, 0,
                 width, height,
                 Justification::centredLeft, true);
@@ -135,194 +248,624 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
 
         if (columnId == 2)
         {
-            g.drawText(trackDuration,
+            g.drawText(table.getDurationText(id),
                 2, 0,
                 width, height,
                 Justification::centredLeft, true);
         }
-    }
 
-}
+        if (columnId == 6)
+        {
+            g.drawText(table.getBpmText(id),
+                2, 0,
+                width, height,
+                Justification::centredLeft, true);
+        }
 
-Component* PlaylistComponent::refreshComponentForCell(int rowNumber,
-    int columnId,
-    bool isRowSelected,
-    Component* existingComponentToUpdate)
-{
-    if (columnId == 3)
-    {
-        if (existingComponentToUpdate == nullptr)
+        if (columnId == 9)
         {
-            TextButton* btn = new TextButton("Load Left");
-            String id{std::to_string(rowNumber)};
-            btn->setComponentID(id);
+            g.drawText(table.getKeyText(id),
+                2, 0,
+                width, height,
+                Justification::centredLeft, true);
+        }
 
+        if (columnId == 7)
+        {
+            g.drawText(table.getDateAddedText(id),
+                2, 0,
+                width, height,
+                Justification::centredLeft, true);
+        }
 
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
+        //Row buttons are painted, rows have no child components to create or reuse
+        if (columnId == 3 || columnId == 4 || columnId == 5 || columnId == 10)
+        {
+            static const String loadLeftText("Load Left");
+            static const String loadRightText("Load Right");
+            static const String removeText("X");
+            static const String previewText("Preview");
+            static const String stopPreviewText("Stop");
+
+            bool previewing = columnId == 10 && id == previewingTrack;
+            auto button = getCellButtonBounds(width, height).toFloat();
+            g.setColour(columnId == 5 ? juce::Colours::red
+                        : previewing  ? juce::Colour(0xFF1DB954)
+                                      : juce::Colour(0xFF3A3A3A));
+            g.fillRoundedRectangle(button, 3.0f);
+
+            g.setColour(juce::Colours::white);
+            g.drawText(columnId == 3 ? loadLeftText : columnId == 4 ? loadRightText
+                       : columnId == 10 ? (previewing ? stopPreviewText : previewText) : removeText,
+                button, Justification::centred, true);
         }
     }
-    if (columnId == 4)
+
+}
+
+void PlaylistComponent::cellClicked(int rowNumber, int columnId, const MouseEvent& event)
+{
+    if (rowNumber >= static_cast<int>(getRows().size()))
+        return;
+
+    //Right click puts the track, or the selected tracks, in a crate
+    if (event.mods.isPopupMenu())
     {
-        if (existingComponentToUpdate == nullptr)
-        {
-            TextButton* btn = new TextButton("Load Right");
-            String id{ std::to_string(rowNumber) };
-            btn->setComponentID(id);
+        showTrackMenu(rowNumber);
+        return;
+    }
 
+    //Only a click on the painted button counts, not the margin around it. The event
+    //is relative to the row, so the cell is the column's span of it, wherever the
+    //table is scrolled to
+    auto& header = tableComponent.getHeader();
+    auto column = header.getColumnPosition(header.getIndexOfColumnId(columnId, true));
+    auto button = getCellButtonBounds(column.getWidth(), tableComponent.getRowHeight());
+    if (!button.contains(event.x - column.getX(), event.y))
+        return;
 
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
+    if (columnId == 3 || columnId == 4)
+    {
+        // Load the track to the left or right deck
+        loadTrackToDeck(columnId == 3 ? 1 : 2, rowNumber);
     }
-    if (columnId == 5)
+    else if (columnId == 10)
     {
-        if (existingComponentToUpdate == nullptr)
+        // Audition the track, a second click stops it
+        TrackTable::TrackId id = getRows()[rowNumber];
+        if (id == previewingTrack)
         {
-            TextButton* btn = new TextButton("X");
-            String id{ std::to_string(rowNumber) };
-            btn->setComponentID(id);
-
-            // Set button properties
-            btn->setColour(TextButton::buttonColourId, juce::Colours::red); // Set background color to red
-
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
+            previewPlayer.stop();
+            previewingTrack = -1;
         }
+        else
+        {
+            previewPlayer.play(File(library.getTable().getPath(id)));
+            previewingTrack = id;
+        }
+        tableComponent.repaint();
     }
-    return existingComponentToUpdate;
+    else if (columnId == 5)
+    {
+        // Remove the track from the crate shown, or from the library - OWN code
+        TrackTable::TrackId id = getRows()[rowNumber];
+        if (currentCrate >= 0)
+            library.getCrates().removeTracks(currentCrate, { id });
+        else
+            library.removeTrack(id);
+        updateVisibleRows();
+    }
+}
 
+Rectangle<int> PlaylistComponent::getCellButtonBounds(int width, int height)
+{
+    return Rectangle<int>(0, 0, width, height).reduced(4, 2);
 }
 
 void PlaylistComponent::buttonClicked(Button* button)
 {
 	if (button == &addTrackButton)
 	{
-        //File chooser to choose track
-		auto fileChooserFlags = FileBrowserComponent::canSelectFiles;
+        //File chooser to choose tracks or whole folders
+		auto fileChooserFlags = FileBrowserComponent::canSelectFiles
+                              | FileBrowserComponent::canSelectDirectories
+                              | FileBrowserComponent::canSelectMultipleItems;
 		fChooser.launchAsync(fileChooserFlags, [this](const FileChooser& chooser)
 			{
-				File file = chooser.getResult();
-				if (file.exists())
-				{
-					//Create a reader for the file
-                    auto* reader = formatManager.createReaderFor(file);
-
-                    if (reader != nullptr)
-                    {
-						std::cout << "Reder not null" << std::endl;
-                        //Get file name
-                        std::string fileName = file.getFileName().toStdString();
-                        //Calculate duration in seconds
-                        double durationInSecs = reader->lengthInSamples / reader->sampleRate;
-						std::string formatedDuration = Utilities::formatTotalTime(durationInSecs);
-                        //Get path for the file
-						std::string path = file.getFullPathName().toStdString();
-
-                        playlistInfoJSON[fileName]["Duration"] = formatedDuration;
-						playlistInfoJSON[fileName]["Path"] = path;
-                        savePlaylistToFile();
-
-                        //Update track titles
-                        updateTrackTitles();
-
-                        // Update the table component
-                        tableComponent.updateContent();
-                        repaint();
-                    }
-				}
+                StringArray paths;
+                for (const auto& file : chooser.getResults())
+                    paths.add(file.getFullPathName());
 
+                if (!paths.isEmpty())
+                    importPaths(paths);
 			});
 	}
-    else
+    else if (button == &autoDJButton)
+    {
+        if (autoDJ.isRunning())
+            autoDJ.stop();
+        else
+            startAutoDJ();
+    }
+    else if (button == &exportButton)
+    {
+        auto fileChooserFlags = FileBrowserComponent::saveMode
+                              | FileBrowserComponent::canSelectFiles
+                              | FileBrowserComponent::warnAboutOverwriting;
+        exportChooser.launchAsync(fileChooserFlags, [this](const FileChooser& chooser)
+            {
+                File file = chooser.getResult();
+                if (file == File())
+                    return;
+
+                //m3u8 unless another playlist format was asked for
+                if (PlaylistFile::getFormat(file) == PlaylistFile::Format::none)
+                    file = file.withFileExtension("m3u8");
+
+                if (!library.exportPlaylist(file))
+                    std::cout << "PlaylistComponent::buttonClicked - can't export to " << file.getFullPathName() << std::endl;
+            });
+    }
+}
+
+bool PlaylistComponent::isInterestedInFileDrag(const StringArray& files)
+{
+    return true;
+}
+
+void PlaylistComponent::filesDropped(const StringArray& files, int x, int y)
+{
+    std::cout << "PlaylistComponent::filesDropped - " << files.size() << " files" << std::endl;
+    importPaths(files);
+}
+
+void PlaylistComponent::libraryLoaded()
+{
+    updateVisibleRows();
+    updateCrateSelector();
+    Utilities::logStartupPhase("library complete, " + std::to_string(getRows().size()) + " rows");
+
+    //Analyse tracks added before beat grids were stored
+    const TrackTable& table = library.getTable();
+    for (TrackTable::TrackId id : table.getIds())
+    {
+        if (!table.hasBeatGrid(id))
+            queueAnalysis(id);
+    }
+
+    //Tracks from before content hashes are fingerprinted in the background, they
+    //keep their row and analysis and from then on are found by content. Their
+    //duration is known, so the files aren't opened by a decoder again
+    std::vector<TrackInfo> unhashed;
+    for (TrackTable::TrackId id : table.getIds())
+    {
+        if (table.getContentHash(id) == 0)
+            unhashed.push_back(table.getTrack(id));
+    }
+    if (!unhashed.empty())
+        importer.fingerprintAsync(unhashed);
+
+    //Files dropped while the library loaded
+    if (!pendingImports.isEmpty())
+    {
+        importPaths(pendingImports);
+        pendingImports.clear();
+    }
+
+    watchedFoldersFile.readLines(watchedFolders);
+    watchedFolders.removeEmptyStrings();
+    for (const auto& folder : watchedFolders)
+        watcher.watch(File(folder));
+}
+
+void PlaylistComponent::importPaths(const StringArray& paths)
+{
+    //Imports find tracks already in the library by key, so they wait for all of it
+    if (!library.isLoaded())
+    {
+        pendingImports.addArray(paths);
+        importStatus.setText("Loading the library...", dontSendNotification);
+        return;
+    }
+
+    //Files already in the playlist are skipped before anything is opened
+    const TrackTable& table = library.getTable();
+    std::unordered_set<std::string> knownPaths;
+    knownPaths.reserve(table.getNumTracks());
+    for (TrackTable::TrackId id : table.getIds())
+    {
+        if (table.getContentHash(id) != 0)
+            knownPaths.insert(table.getPath(id));
+    }
+
+    importer.importAsync(paths, knownPaths);
+
+    for (const auto& path : paths)
+    {
+        if (File(path).isDirectory())
+            watchFolder(File(path));
+    }
+}
+
+void PlaylistComponent::watchFolder(const File& folder)
+{
+    //A folder inside one already watched is covered by it
+    for (const auto& watched : watchedFolders)
+    {
+        if (folder == File(watched) || folder.isAChildOf(File(watched)))
+            return;
+    }
+
+    watchedFolders.add(folder.getFullPathName());
+    watchedFoldersFile.replaceWithText(watchedFolders.joinIntoString("\n"));
+    watcher.watch(folder);
+}
+
+void PlaylistComponent::applyFolderChanges(const StringArray& changed, const StringArray& removed)
+{
+    pendingRemovals.addArray(removed);
+
+    if (!changed.isEmpty())
     {
-        int id = std::stoi(button->getComponentID().toStdString());
-		//Remove button - OWN code
-        if (button->getButtonText() == "X")
+        //A file saved again is probed again, its new content hash replaces the old one
+        const TrackTable& table = library.getTable();
+        std::unordered_set<std::string> knownPaths;
+        knownPaths.reserve(table.getNumTracks());
+        for (TrackTable::TrackId id : table.getIds())
         {
-            // Remove the track from the JSON
-            std::string trackName = trackTitles[id];
-            playlistInfoJSON.erase(trackName);
+            if (table.getContentHash(id) != 0)
+                knownPaths.insert(table.getPath(id));
+        }
+        for (const auto& path : changed)
+            knownPaths.erase(path.toStdString());
 
-            // Save the updated JSON to the file
-            savePlaylistToFile();
+        importer.importAsync(changed, knownPaths);
+    }
 
-            // Update track titles
-            updateTrackTitles();
+    //A moved file is relinked by its content when the import finds it, so
+    //removals wait for the import and only take tracks still at their old path
+    if (!importer.isImporting())
+        applyPendingRemovals();
+}
 
-            // Update the table component
-            tableComponent.updateContent();
-            repaint();
+void PlaylistComponent::checkFoldersForRemovals(const StringArray& folders)
+{
+    //Every track below the folders is a candidate, the ones whose file is still
+    //there are kept when the removals are applied
+    const TrackTable& table = library.getTable();
+    for (const auto& path : folders)
+    {
+        std::string folder = (path + File::getSeparatorString()).toStdString();
+        for (TrackTable::TrackId track : table.getIds())
+        {
+            if (table.getPath(track).compare(0, folder.size(), folder) == 0)
+                pendingRemovals.add(table.getPath(track));
         }
-        else
+    }
+
+    if (!importer.isImporting())
+        applyPendingRemovals();
+}
+
+void PlaylistComponent::applyPendingRemovals()
+{
+    if (pendingRemovals.isEmpty())
+        return;
+
+    const TrackTable& table = library.getTable();
+    std::vector<TrackTable::TrackId> gone;
+    for (const auto& path : pendingRemovals)
+    {
+        //Put back since, or saved by renaming a new copy over it
+        if (File(path).exists())
+            continue;
+
+        TrackTable::TrackId id = table.findTrackByPath(path.toStdString());
+        if (id >= 0)
+        {
+            gone.push_back(id);
+            continue;
+        }
+
+        //A folder, every track below it goes
+        std::string folder = (path + File::getSeparatorString()).toStdString();
+        for (TrackTable::TrackId track : table.getIds())
         {
-			// Load the track to the left or right deck
-			int deckNumber = button->getButtonText() == "Load Left" ? 1 : 2;
-			loadTrackToDeck(deckNumber, button->getButtonText().toStdString(), id);
+            if (table.getPath(track).compare(0, folder.size(), folder) == 0)
+                gone.push_back(track);
         }
     }
+    pendingRemovals.clear();
+
+    if (gone.empty())
+        return;
+
+    std::cout << "PlaylistComponent::applyPendingRemovals - " << gone.size() << " tracks gone" << std::endl;
+    library.beginBatch();
+    for (TrackTable::TrackId id : gone)
+        library.removeTrack(id);
+    library.endBatch();
+
+    updateVisibleRows();
 }
 
-//OWN code, reference from JUCE File class documentation and nlohmann json library
-//https://docs.juce.com/master/classFile.html
-//	--Write and read json
-//https://www.reddit.com/r/cpp/comments/ovhrhn/what_json_library_do_you_suggest/
-//https://stackoverflow.com/questions/70684671/how-do-i-read-write-json-with-c
-// --nlohman json documentation
-// https://github.com/nlohmann/json/blob/develop/README.md#creating-json-objects-from-json-literals 
-// --Importing nlohman / json to JUCE
-//https://forum.juce.com/t/importing-third-party-libraries-in-a-juce-project/36389/2
-void PlaylistComponent::savePlaylistToFile()
+void PlaylistComponent::addTracks(const std::vector<TrackInfo>& tracks)
 {
-    try {
-		// Get the path to the dataFiles folder and the playlist file
-        juce::File dataFilesFolder = juce::File::getSpecialLocation(juce::File::currentApplicationFile)
-            .getParentDirectory().getChildFile("dataFiles");
+    library.beginBatch();
+    for (const auto& track : tracks)
+    {
+        TrackTable::TrackId id = library.addTrack(track);
 
-		// Create the dataFiles folder if it doesn't exist
-        if (!dataFilesFolder.exists())
-            dataFilesFolder.createDirectory();
+        //Beat grid is computed in the background and stored later, moved tracks keep theirs
+        if (!library.getTable().hasBeatGrid(id))
+            queueAnalysis(id);
+    }
+    library.endBatch();
 
-        juce::File playlistFile = dataFilesFolder.getChildFile("playlist.json");
+    updateVisibleRows();
+}
 
-        std::ofstream o(playlistFile.getFullPathName().toStdString());
-        if (!o.is_open())
-            throw std::runtime_error("Failed to open file");
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards)
+{
+    sortColumnId = newSortColumnId;
+    sortForwards = isForwards;
+    updateVisibleRows();
+}
 
-        o << playlistInfoJSON.dump(4);
-        o.close();
+TrackTable::SortColumn PlaylistComponent::getSortColumn(int columnId)
+{
+    switch (columnId)
+    {
+        case 2: return TrackTable::SortColumn::duration;
+        case 6: return TrackTable::SortColumn::bpm;
+        case 7: return TrackTable::SortColumn::dateAdded;
+        case 8: return TrackTable::SortColumn::artist;
+        case 9: return TrackTable::SortColumn::key;
+        default: return TrackTable::SortColumn::title;
     }
-    catch (const std::exception& e) {
-        // Log error
+}
+
+void PlaylistComponent::updateVisibleRows()
+{
+    lastLoadUpdateMs = Time::getMillisecondCounterHiRes();
+
+    //Without a search or a sort the table shows the library or the crate's own
+    //array, switching crates rebinds the rows without building anything
+    String query = searchBox.getText();
+    rowsFiltered = query.trim().isNotEmpty() || sortColumnId != 0;
+    if (rowsFiltered)
+    {
+        visibleRows = library.search(query);
+
+        //Tracks of the crate that match, in the crate's order
+        if (currentCrate >= 0)
+        {
+            std::vector<TrackTable::TrackId> matches;
+            matches.swap(visibleRows);
+            for (TrackTable::TrackId id : library.getCrates().getTracks(currentCrate))
+            {
+                if (std::binary_search(matches.begin(), matches.end(), id))
+                    visibleRows.push_back(id);
+            }
+        }
+
+        //Sorted by walking the column's sort order, the tracks themselves aren't touched
+        if (sortColumnId != 0)
+        {
+            std::sort(visibleRows.begin(), visibleRows.end());
+            visibleRows = library.getTable().sortIds(visibleRows, getSortColumn(sortColumnId), sortForwards);
+        }
+    }
+    else
+    {
+        visibleRows.clear();
     }
+
+    // Update the table component
+    tableComponent.updateContent();
+    repaint();
+}
+
+const std::vector<TrackTable::TrackId>& PlaylistComponent::getRows() const
+{
+    if (rowsFiltered)
+        return visibleRows;
+    if (currentCrate >= 0)
+        return library.getCrates().getTracks(currentCrate);
+    return library.getTable().getIds();
+}
+
+void PlaylistComponent::selectCrate(int crate)
+{
+    currentCrate = crate;
+    tableComponent.deselectAllRows();
+    updateVisibleRows();
+}
+
+void PlaylistComponent::updateCrateSelector()
+{
+    //Item ids are the crate index plus 2, 1 is the whole library
+    CrateStore& crates = library.getCrates();
+    crateSelector.clear(dontSendNotification);
+    crateSelector.addItem("All tracks", 1);
+    for (int crate = 0; crate < crates.getNumCrates(); ++crate)
+        crateSelector.addItem(crates.getName(crate), crate + 2);
+    crateSelector.addSeparator();
+    crateSelector.addItem("New crate...", newCrateItemId);
+    if (currentCrate >= 0)
+        crateSelector.addItem("Delete crate", deleteCrateItemId);
+    crateSelector.setSelectedId(currentCrate + 2, dontSendNotification);
 }
 
-void PlaylistComponent::updateTrackTitles()
+void PlaylistComponent::crateSelected()
 {
-    trackTitles.clear(); // Clear the existing titles
-    for (auto& [key, value] : playlistInfoJSON.items())
+    int itemId = crateSelector.getSelectedId();
+    if (itemId == newCrateItemId)
+    {
+        crateSelector.setSelectedId(currentCrate + 2, dontSendNotification);
+        createCrate({});
+    }
+    else if (itemId == deleteCrateItemId)
+    {
+        library.getCrates().removeCrate(currentCrate);
+        selectCrate(-1);
+        updateCrateSelector();
+    }
+    else if (itemId > 0)
     {
-        trackTitles.push_back(key); // Add track title to the list
+        selectCrate(itemId - 2);
+        updateCrateSelector();
     }
 }
 
+void PlaylistComponent::createCrate(const std::vector<TrackTable::TrackId>& tracks)
+{
+    auto* window = new AlertWindow("New crate", "Name of the crate", MessageBoxIconType::NoIcon);
+    window->addTextEditor("name", "Crate " + String(library.getCrates().getNumCrates() + 1));
+    window->addButton("Create", 1, KeyPress(KeyPress::returnKey));
+    window->addButton("Cancel", 0, KeyPress(KeyPress::escapeKey));
+    window->enterModalState(true, ModalCallbackFunction::create(
+        [safeThis = Component::SafePointer<PlaylistComponent>(this), window, tracks](int result)
+        {
+            String name = window->getTextEditorContents("name").trim();
+            if (safeThis == nullptr || result == 0 || name.isEmpty())
+                return;
+
+            CrateStore& crates = safeThis->library.getCrates();
+            int crate = crates.addCrate(name);
+            crates.addTracks(crate, tracks);
+            safeThis->updateCrateSelector();
+        }), true);
+}
 
-void PlaylistComponent::loadTrackToDeck(int deckNumber, std::string btnName, int btnId)
+void PlaylistComponent::showTrackMenu(int rowNumber)
 {
-	std::string trackName = trackTitles[btnId];
-	std::string trackPath = playlistInfoJSON[trackName]["Path"];
+    //Crates only hold tracks once the library has loaded
+    if (!library.isLoaded())
+        return;
+
+    //The selected tracks when the row is one of them, the row alone otherwise
+    const std::vector<TrackTable::TrackId>& rows = getRows();
+    std::vector<TrackTable::TrackId> tracks;
+    if (tableComponent.isRowSelected(rowNumber))
+    {
+        SparseSet<int> selected = tableComponent.getSelectedRows();
+        for (int index = 0; index < selected.size(); ++index)
+        {
+            if (selected[index] < static_cast<int>(rows.size()))
+                tracks.push_back(rows[selected[index]]);
+        }
+    }
+    else
+    {
+        tracks.push_back(rows[rowNumber]);
+    }
+
+    CrateStore& crates = library.getCrates();
+    PopupMenu addToCrate;
+    for (int crate = 0; crate < crates.getNumCrates(); ++crate)
+        addToCrate.addItem(crates.getName(crate), crate != currentCrate, false,
+                           [this, crate, tracks] { library.getCrates().addTracks(crate, tracks); });
+    addToCrate.addSeparator();
+    addToCrate.addItem("New crate...", [this, tracks] { createCrate(tracks); });
+
+    PopupMenu menu;
+    menu.addSubMenu("Add to crate", addToCrate);
+    if (currentCrate >= 0)
+    {
+        menu.addItem("Remove from crate", [this, tracks]
+        {
+            library.getCrates().removeTracks(currentCrate, tracks);
+            updateVisibleRows();
+        });
+    }
+    menu.showMenuAsync(PopupMenu::Options().withMousePosition());
+}
+
+void PlaylistComponent::loadTrackToDeck(int deckNumber, int rowNumber)
+{
+	const TrackTable& table = library.getTable();
+	TrackTable::TrackId id = getRows()[rowNumber];
+	std::string trackPath = table.getPath(id);
     //from string to juce url
     juce::File trackFile(trackPath);
     juce::URL url = juce::URL(trackFile);
 
+    //Stored beat grid, empty if the analysis hasn't finished yet
+    BeatGrid beatGrid = BeatGrid::fromArray(table.getBeatGrid(id));
+    //Stored fingerprint, the deck doesn't read the file again to find its waveform
+    uint64 contentHash = table.getContentHash(id);
+
 	if (deckNumber == 1)
 	{
-		leftDeck.loadURL(url);
+		leftDeck.loadURL(url, beatGrid, contentHash);
 	}
 	else
 	{
-		rightDeck.loadURL(url);
+		rightDeck.loadURL(url, beatGrid, contentHash);
 	}
 	
 
-}
\ No newline at end of file
+}
+
+void PlaylistComponent::startAutoDJ()
+{
+    //From the first selected row to the end of what is shown, crate, search and sort included
+    const TrackTable& table = library.getTable();
+    const std::vector<TrackTable::TrackId>& rows = getRows();
+    int firstRow = jmax(0, tableComponent.getSelectedRow());
+
+    std::vector<AutoDJ::Entry> tracks;
+    for (int row = firstRow; row < static_cast<int>(rows.size()); ++row)
+    {
+        TrackTable::TrackId id = rows[row];
+        tracks.push_back({ id, File(table.getPath(id)), BeatGrid::fromArray(table.getBeatGrid(id)),
+                           table.getContentHash(id) });
+    }
+    if (tracks.empty())
+        return;
+
+    autoDJ.start(tracks);
+    autoDJButton.setToggleState(true, dontSendNotification);
+}
+
+void PlaylistComponent::analyseTrack(TrackTable::TrackId id)
+{
+    juce::File trackFile(library.getTable().getPath(id));
+    if (!trackFile.existsAsFile())
+        return;
+
+    ++analysesRunning;
+    trackAnalyser.analyseAsync(trackFile,
+        [safeThis = Component::SafePointer<PlaylistComponent>(this), id](const BeatGrid& grid)
+        {
+            if (safeThis == nullptr)
+                return;
+
+            //A track without a beat found is marked, it isn't analysed again next time.
+            //The track may have been removed while it was analysed, then nothing is stored
+            safeThis->library.setBeatGrid(id, grid.isValid() ? grid.toArray() : BeatGrid::noGridFound());
+            --safeThis->analysesRunning;
+            safeThis->analyseQueued();
+        });
+}
+
+void PlaylistComponent::queueAnalysis(TrackTable::TrackId id)
+{
+    analysisQueue.push_back(id);
+    analyseQueued();
+}
+
+void PlaylistComponent::analyseQueued()
+{
+    const TrackTable& table = library.getTable();
+    while (analysesRunning < maxAnalysesRunning && !analysisQueue.empty())
+    {
+        TrackTable::TrackId id = analysisQueue.front();
+        analysisQueue.pop_front();
+
+        //Removed, or given a grid by Auto-DJ, while it waited
+        if (table.contains(id) && !table.hasBeatGrid(id))
+            analyseTrack(id);
+    }
+}
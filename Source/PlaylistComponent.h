@@ -11,21 +11,32 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <deque>
 #include <vector>
 #include <string>
+#include <unordered_set>
 #include "../Thirdparty/nlohmann/json.hpp"
 #include "Utilities.h"
 #include "DeckGUI.h"
+#include "TrackAnalyser.h"
+#include "AutoDJ.h"
+#include "PreviewPlayer.h"
+#include "LibraryImporter.h"
+#include "LibraryWatcher.h"
+#include "TagReader.h"
+#include "TrackLibrary.h"
 
 //==============================================================================
 /*
 */
 class PlaylistComponent  : public juce::Component,
                            public juce::TableListBoxModel,
-                           public Button::Listener
+                           public Button::Listener,
+                           public FileDragAndDropTarget
 {
 public:
-    PlaylistComponent(DeckGUI& leftDeck, DeckGUI& rightDeck);
+    PlaylistComponent(DeckGUI& leftDeck, DeckGUI& rightDeck, TrackAnalyser& trackAnalyser,
+                      AudioFormatManager& formatManager, AutoDJ& autoDJ, PreviewPlayer& previewPlayer);
     ~PlaylistComponent() override;
 
     void paint (juce::Graphics&) override;
@@ -46,39 +57,155 @@ public:
 					int height,
 					bool rowIsSelected) override;
 
-    Component*  refreshComponentForCell(int rowNumber, 
-                                        int columnId, 
-                                        bool isRowSelected, 
-                                        Component* existingComponentToUpdate) override;
+    void cellClicked(int rowNumber, int columnId, const MouseEvent& event) override;
+
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override;
 
     void buttonClicked(Button* button) override;
 
-    /** Function to save the added track to the json file**/
-	void savePlaylistToFile();
+    bool isInterestedInFileDrag(const StringArray& files) override;
+    void filesDropped(const StringArray& files, int x, int y) override;
+
+    /** Function to start what needs the whole library once it is loaded**/
+    void libraryLoaded();
+
+    /** Function to import files and folders dropped or chosen, in the background**/
+    void importPaths(const StringArray& paths);
+
+    /** Function to watch an imported folder from now on, also in later sessions**/
+    void watchFolder(const File& folder);
+
+    /** Function to bring the library up to date with files changed in the watched folders**/
+    void applyFolderChanges(const StringArray& changed, const StringArray& removed);
+
+    /** Function to remove the tracks of files no longer in the folders, for when the
+    watcher lost their events**/
+    void checkFoldersForRemovals(const StringArray& folders);
+
+    /** Function to remove the tracks of files deleted or moved out, once the import
+    that could find them elsewhere is done**/
+    void applyPendingRemovals();
+
+    /** Function to add a batch of imported tracks to the library**/
+    void addTracks(const std::vector<TrackInfo>& tracks);
+
+    /** Function to filter the rows by the search box and sort them by the chosen column**/
+    void updateVisibleRows();
+
+    /** Function to get the track of every row, the filtered rows or the ids of the library
+    or crate shown**/
+    const std::vector<TrackTable::TrackId>& getRows() const;
+
+    /** Function to show a crate, -1 for the whole library**/
+    void selectCrate(int crate);
+
+    /** Function to list the crates in the selector, with the one shown selected**/
+    void updateCrateSelector();
+
+    /** Function to show the crate picked in the selector, or create or delete one**/
+    void crateSelected();
+
+    /** Function to ask for a name and create a crate holding tracks**/
+    void createCrate(const std::vector<TrackTable::TrackId>& tracks);
+
+    /** Function to show the crate menu for a row, or for the selected rows**/
+    void showTrackMenu(int rowNumber);
 
-    /** Function repopulate the track titles array**/
-    void updateTrackTitles();
+    /** Function to play the rows shown through Auto-DJ, from the selected one**/
+    void startAutoDJ();
+
+    /** Function to get the area of the button painted in a deck or remove cell**/
+    static Rectangle<int> getCellButtonBounds(int width, int height);
+
+    /** Function to map a sortable column of the table to its sort order**/
+    static TrackTable::SortColumn getSortColumn(int columnId);
 
 	/** Function to load track to left-right decks**/
-	void loadTrackToDeck(int deckNumber, std::string btnName, int btnId);
+	void loadTrackToDeck(int deckNumber, int rowNumber);
+
+    /** Function to analyse a track in the background and store its beat grid**/
+    void analyseTrack(TrackTable::TrackId id);
+
+    /** Function to analyse a track once the ones queued before it are done**/
+    void queueAnalysis(TrackTable::TrackId id);
+
+    /** Function to start queued analyses while fewer than maxAnalysesRunning run**/
+    void analyseQueued();
 
 private:
     // References to the deck components
     DeckGUI& leftDeck;
     DeckGUI& rightDeck;
 
-    AudioFormatManager formatManager;
+    TrackAnalyser& trackAnalyser;
+
+    AutoDJ& autoDJ;
+
+    //auditions a track from its row without taking a deck
+    PreviewPlayer& previewPlayer;
+    //row whose preview is opening or playing, -1 when none is, set again by onChange
+    TrackTable::TrackId previewingTrack = -1;
+
     juce::FileChooser fChooser{ "Select a file..." };
 
     TextButton addTrackButton{ "+ Add Track" };
 
+    juce::FileChooser exportChooser{ "Export the playlist...", File(), "*.m3u8;*.pls;*.json" };
+
+    TextButton exportButton{ "Export" };
+
+    TextButton autoDJButton{ "Auto DJ" };
+
+    Label importStatus;
+
+    TextEditor searchBox;
+
     TableListBox tableComponent;
    
-	//json to store playlist info - OWN code
-    nlohmann::json playlistInfoJSON{};
-
-	//vector to store track titles
-    std::vector<std::string> trackTitles{};
+	//tracks of the playlist, mapped from the library index
+    TrackLibrary library;
+
+    //track of every row shown when searching or sorted, the ids matching the search
+    std::vector<TrackTable::TrackId> visibleRows;
+    bool rowsFiltered = false;
+
+    //crate shown, -1 for the whole library
+    ComboBox crateSelector;
+    int currentCrate = -1;
+    static constexpr int newCrateItemId = 1000000;
+    static constexpr int deleteCrateItemId = 1000001;
+
+    //column clicked in the header, 0 keeps the library order
+    int sortColumnId = 0;
+    bool sortForwards = true;
+
+    //probes dropped files and folders on a thread pool
+    LibraryImporter importer;
+
+    //folders imported once are followed, one path per line in the file
+    File watchedFoldersFile;
+    StringArray watchedFolders;
+    LibraryWatcher watcher;
+
+    //files gone from the watched folders, removed when the import running ends
+    StringArray pendingRemovals;
+
+    //files dropped while the library loads, imported once it has
+    StringArray pendingImports;
+
+    //rows are refreshed a few times a second while the library loads, not per chunk
+    static constexpr double loadUpdateIntervalMs = 250.0;
+    double lastLoadUpdateMs = 0.0;
+    bool firstRowsLogged = false;
+
+    //tags of the rows painted, read in the background and cached in the library
+    TagReader tagReader;
+
+    //tracks waiting for their beat grid, handed to the analyser a few at a time
+    //so a library without grids doesn't queue a job per track at once
+    std::deque<TrackTable::TrackId> analysisQueue;
+    int analysesRunning = 0;
+    static constexpr int maxAnalysesRunning = 2;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
 };
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+    PlaylistFile.cpp
+    Created: 20 Oct 2026 2:14:52am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PlaylistFile.h"
+#include "TrackLibrary.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    std::string trimmed(const std::string& text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos)
+            return {};
+        return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+    bool startsWith(const std::string& text, const char* prefix)
+    {
+        return text.compare(0, std::strlen(prefix), prefix) == 0;
+    }
+
+    //m3u from older players is Latin-1, anything that isn't valid UTF-8 is taken as that
+    std::string toUTF8(const std::string& line)
+    {
+        if (CharPointer_UTF8::isValidString(line.data(), static_cast<int>(line.size())))
+            return line;
+
+        std::string converted;
+        for (unsigned char c : line)
+        {
+            if (c < 0x80)
+            {
+                converted += static_cast<char>(c);
+            }
+            else
+            {
+                converted += static_cast<char>(0xc0 | (c >> 6));
+                converted += static_cast<char>(0x80 | (c & 0x3f));
+            }
+        }
+        return converted;
+    }
+
+    /** The file an entry points at, none for streams **/
+    File resolveEntry(const std::string& entry, const File& folder)
+    {
+        if (startsWith(entry, "file://"))
+            return URL(String(entry)).getLocalFile();
+        if (entry.find("://") != std::string::npos)
+            return File();
+        if (File::isAbsolutePath(String(entry)))
+            return File(String(entry));
+        return folder.getChildFile(String(entry));
+    }
+
+    TrackInfo makeEntry(const File& file, double lengthSeconds)
+    {
+        TrackInfo track;
+        track.title = file.getFileName().toStdString();
+        track.path = file.getFullPathName().toStdString();
+        track.durationSeconds = jmax(0.0, lengthSeconds);
+        return track;
+    }
+
+    bool writeText(OutputStream& out, const std::string& text)
+    {
+        return out.write(text.data(), text.size());
+    }
+
+    /** Artist - title from the tags, the file name without them **/
+    std::string getDisplayTitle(const TrackInfo& track)
+    {
+        std::string title = track.tags.title.empty() ? File(String(track.path)).getFileNameWithoutExtension().toStdString()
+                                                     : track.tags.title;
+        return track.tags.artist.empty() ? title : track.tags.artist + " - " + title;
+    }
+}
+
+PlaylistFile::Format PlaylistFile::getFormat(const File& file)
+{
+    if (file.hasFileExtension("json"))
+        return Format::json;
+    if (file.hasFileExtension("m3u;m3u8"))
+        return Format::m3u;
+    if (file.hasFileExtension("pls"))
+        return Format::pls;
+    return Format::none;
+}
+
+//==============================================================================
+bool PlaylistFile::read(const File& file, const std::function<void(TrackInfo&&)>& onTrack)
+{
+    std::ifstream input(file.getFullPathName().toStdString(), std::ios::binary);
+    if (!input)
+    {
+        std::cout << "PlaylistFile::read - can't open " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    switch (getFormat(file))
+    {
+        case Format::json: return readJSON(input, onTrack);
+        case Format::m3u:  return readM3U(input, file.getParentDirectory(), onTrack);
+        case Format::pls:  return readPLS(input, file.getParentDirectory(), onTrack);
+        case Format::none: break;
+    }
+    return false;
+}
+
+bool PlaylistFile::readJSON(std::istream& input, const std::function<void(TrackInfo&&)>& onTrack)
+{
+    //the parser's callback sees every entry once it is complete; dropping it
+    //there keeps the document from ever being built
+    std::string key;
+    auto callback = [&](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed)
+    {
+        if (depth != 1)
+            return true;
+
+        if (event == nlohmann::json::parse_event_t::key)
+        {
+            key = parsed.get<std::string>();
+            return true;
+        }
+        if (event == nlohmann::json::parse_event_t::object_end)
+            onTrack(TrackLibrary::fromJSON(key, parsed));
+
+        //entries aren't kept, and a value that isn't an entry is skipped
+        return event == nlohmann::json::parse_event_t::object_start;
+    };
+
+    try
+    {
+        //what is left is the top level object, every entry dropped
+        ignoreUnused(nlohmann::json::parse(input, callback));
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        std::cout << "PlaylistFile::readJSON - " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PlaylistFile::readM3U(std::istream& input, const File& folder, const std::function<void(TrackInfo&&)>& onTrack)
+{
+    //#EXTINF:<seconds>,<title> comes before the path it describes
+    double lengthSeconds = 0.0;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        if (startsWith(line, "\xef\xbb\xbf"))
+            line.erase(0, 3);
+        line = trimmed(line);
+
+        if (startsWith(line, "#EXTINF:"))
+        {
+            lengthSeconds = std::strtod(line.c_str() + 8, nullptr);
+            continue;
+        }
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        File entry = resolveEntry(toUTF8(line), folder);
+        if (entry != File())
+            onTrack(makeEntry(entry, lengthSeconds));
+        lengthSeconds = 0.0;
+    }
+    return !input.bad();
+}
+
+bool PlaylistFile::readPLS(std::istream& input, const File& folder, const std::function<void(TrackInfo&&)>& onTrack)
+{
+    //FileN, TitleN and LengthN of an entry are together, an entry is handed
+    //over as soon as a line of the next one comes
+    int entryNumber = -1;
+    std::string entryPath;
+    double lengthSeconds = 0.0;
+    auto flush = [&]
+    {
+        File entry = entryPath.empty() ? File() : resolveEntry(entryPath, folder);
+        if (entry != File())
+            onTrack(makeEntry(entry, lengthSeconds));
+        entryPath.clear();
+        lengthSeconds = 0.0;
+    };
+
+    std::string line;
+    while (std::getline(input, line))
+    {
+        line = trimmed(line);
+        size_t equals = line.find('=');
+        if (equals == std::string::npos)
+            continue;
+
+        std::string name = line.substr(0, equals);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; });
+        std::string value = toUTF8(trimmed(line.substr(equals + 1)));
+        size_t digits = name.find_first_of("0123456789");
+        if (digits == std::string::npos)
+            continue;
+
+        int number = std::atoi(name.c_str() + digits);
+        if (number != entryNumber)
+        {
+            flush();
+            entryNumber = number;
+        }
+
+        std::string field = name.substr(0, digits);
+        if (field == "file")
+            entryPath = value;
+        else if (field == "length")
+            lengthSeconds = std::strtod(value.c_str(), nullptr);    // -1 for streams
+    }
+    flush();
+    return !input.bad();
+}
+
+//==============================================================================
+bool PlaylistFile::write(const File& file, int numTracks, const std::function<TrackInfo(int)>& getTrack)
+{
+    Format format = getFormat(file);
+    if (format == Format::none)
+        return false;
+
+    TemporaryFile temp(file);
+    {
+        FileOutputStream out(temp.getFile());
+        if (out.failedToOpen())
+        {
+            std::cout << "PlaylistFile::write - can't write " << temp.getFile().getFullPathName() << std::endl;
+            return false;
+        }
+
+        //every entry is written as it is asked for, nothing is gathered first
+        if (format == Format::json)
+        {
+            writeText(out, "{\n");
+            for (int index = 0; index < numTracks; ++index)
+            {
+                TrackInfo track = getTrack(index);
+                writeText(out, "    " + nlohmann::json(track.getKey()).dump() + ": "
+                               + TrackLibrary::toJSON(track).dump() + (index + 1 < numTracks ? ",\n" : "\n"));
+            }
+            writeText(out, "}\n");
+        }
+        else if (format == Format::m3u)
+        {
+            writeText(out, "#EXTM3U\n");
+            for (int index = 0; index < numTracks; ++index)
+            {
+                TrackInfo track = getTrack(index);
+                writeText(out, "#EXTINF:" + std::to_string(std::lround(track.durationSeconds)) + ","
+                               + getDisplayTitle(track) + "\n" + track.path + "\n");
+            }
+        }
+        else
+        {
+            writeText(out, "[playlist]\n");
+            for (int index = 0; index < numTracks; ++index)
+            {
+                TrackInfo track = getTrack(index);
+                std::string number = std::to_string(index + 1);
+                writeText(out, "File" + number + "=" + track.path + "\n"
+                               + "Title" + number + "=" + getDisplayTitle(track) + "\n"
+                               + "Length" + number + "=" + std::to_string(std::lround(track.durationSeconds)) + "\n");
+            }
+            writeText(out, "NumberOfEntries=" + std::to_string(numTracks) + "\nVersion=2\n");
+        }
+
+        out.flush();
+        if (out.getStatus().failed())
+        {
+            std::cout << "PlaylistFile::write - " << out.getStatus().getErrorMessage() << std::endl;
+            return false;
+        }
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    PlaylistFile.h
+    Created: 20 Oct 2026 2:14:52am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include "LibraryIndex.h"
+
+/** Playlist files of this app and of other players, read and written one
+    entry at a time so a playlist of any size costs the memory of one entry.
+
+    json is the playlist.json format, every field of a track. m3u, m3u8 and
+    pls only hold a path, with a title and a length at most, so their tracks
+    still have to be opened to be fingerprinted and analysed. **/
+class PlaylistFile
+{
+public:
+    enum class Format { none, json, m3u, pls };
+
+    /** Format from the file extension, none for anything else **/
+    static Format getFormat(const File& file);
+
+    /** Call onTrack for every entry in the file, in order. Relative paths are
+    taken from the folder of the playlist. False when the file can't be read
+    or is broken, after calling onTrack for the entries before the error **/
+    static bool read(const File& file, const std::function<void(TrackInfo&& track)>& onTrack);
+
+    /** Write numTracks tracks, asked for in order, as a playlist in the format
+    of the file's extension. Written to a temporary file first and renamed **/
+    static bool write(const File& file, int numTracks, const std::function<TrackInfo(int index)>& getTrack);
+
+private:
+    static bool readJSON(std::istream& input, const std::function<void(TrackInfo&&)>& onTrack);
+    static bool readM3U(std::istream& input, const File& folder, const std::function<void(TrackInfo&&)>& onTrack);
+    static bool readPLS(std::istream& input, const File& folder, const std::function<void(TrackInfo&&)>& onTrack);
+};
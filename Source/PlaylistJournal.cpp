@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    PlaylistJournal.cpp
+    Created: 19 Oct 2026 6:20:14pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PlaylistJournal.h"
+#include <fstream>
+
+namespace
+{
+    //journal lines folded into the snapshot at once
+    constexpr int compactEvery = 500;
+
+    //how long the writer sleeps between batches, short enough that nothing waits
+    constexpr int writeIntervalMs = 200;
+}
+
+PlaylistJournal::PlaylistJournal()
+    : Thread("PlaylistJournal")
+{
+}
+
+PlaylistJournal::~PlaylistJournal()
+{
+    close();
+}
+
+PlaylistJournal::Changes PlaylistJournal::open(const File& newJournalFile, SnapshotWriter snapshotWriter)
+{
+    journalFile = newJournalFile;
+    writeSnapshot = std::move(snapshotWriter);
+    changes.clear();
+
+    std::ifstream journal(journalFile.getFullPathName().toStdString());
+    std::string line;
+    std::string validLines;
+    int replayed = 0;
+    bool torn = false;
+    while (std::getline(journal, line))
+    {
+        if (line.empty())
+            continue;
+
+        try
+        {
+            auto record = nlohmann::json::parse(line);
+            changes[record.at("track").get<std::string>()] = record.value("entry", nlohmann::json());
+            validLines += line + '\n';
+            ++replayed;
+        }
+        catch (const nlohmann::json::exception&)
+        {
+            //only the last line can be torn, it was never acknowledged
+            std::cout << "PlaylistJournal::open - dropped a torn journal line" << std::endl;
+            torn = true;
+            break;
+        }
+    }
+    journal.close();
+
+    //appending after a torn line would hide everything after it
+    if (torn)
+    {
+        TemporaryFile temp(journalFile);
+        temp.getFile().replaceWithText(validLines);
+        temp.overwriteTargetFileWithTemporary();
+    }
+
+    //fold what the last session left into the snapshot soon
+    compactionPending = replayed > 0;
+    std::cout << "PlaylistJournal::open - replayed " << replayed << " changes" << std::endl;
+
+    isOpen = true;
+    startThread();
+    return changes;
+}
+
+void PlaylistJournal::close()
+{
+    if (!isOpen)
+        return;
+
+    stopThread(4000);
+
+    //whatever the writer didn't get to goes into a last snapshot
+    batchDepth = 0;
+    writePending();
+    if (changesSinceCompaction > 0 || compactionPending || journalFile.existsAsFile())
+        compact();
+
+    journalStream.reset();
+    isOpen = false;
+}
+
+void PlaylistJournal::recordSet(const std::string& trackName, const nlohmann::json& entry)
+{
+    {
+        const ScopedLock sl(queueLock);
+        queued.push_back({ trackName, entry });
+    }
+    notify();
+}
+
+void PlaylistJournal::recordErase(const std::string& trackName)
+{
+    {
+        const ScopedLock sl(queueLock);
+        queued.push_back({ trackName, nlohmann::json() });
+    }
+    notify();
+}
+
+void PlaylistJournal::beginBatch()
+{
+    const ScopedLock sl(queueLock);
+    ++batchDepth;
+}
+
+void PlaylistJournal::endBatch()
+{
+    {
+        const ScopedLock sl(queueLock);
+        batchDepth = jmax(0, batchDepth - 1);
+    }
+    notify();
+}
+
+//==============================================================================
+void PlaylistJournal::run()
+{
+    while (!threadShouldExit())
+    {
+        if (compactionPending)
+            compact();
+
+        writePending();
+
+        if (changesSinceCompaction >= compactEvery)
+            compact();
+
+        wait(writeIntervalMs);
+    }
+}
+
+void PlaylistJournal::writePending()
+{
+    std::vector<Change> pending;
+    {
+        const ScopedLock sl(queueLock);
+        //a batch is written in one go once it ends
+        if (batchDepth > 0 || queued.empty())
+            return;
+
+        pending.swap(queued);
+    }
+
+    if (journalStream == nullptr)
+    {
+        journalStream = std::make_unique<FileOutputStream>(journalFile);
+        if (journalStream->failedToOpen())
+        {
+            std::cout << "PlaylistJournal::writePending - can't open " << journalFile.getFullPathName() << std::endl;
+            journalStream.reset();
+            compactionPending = true;
+        }
+    }
+
+    std::string lines;
+    for (const auto& change : pending)
+    {
+        changes[change.trackName] = change.entry;
+
+        nlohmann::json record{ { "track", change.trackName } };
+        if (!change.entry.is_null())
+            record["entry"] = change.entry;
+        lines += record.dump();
+        lines += '\n';
+    }
+
+    if (journalStream != nullptr)
+    {
+        //one write and one sync for the whole batch
+        journalStream->write(lines.data(), lines.size());
+        journalStream->flush();
+    }
+
+    changesSinceCompaction += static_cast<int>(pending.size());
+}
+
+void PlaylistJournal::compact()
+{
+    //the snapshot gets every change since open, the journal only goes once it is written
+    if (writeSnapshot == nullptr || !writeSnapshot(changes))
+    {
+        //tried again after the next compactEvery changes and on close
+        std::cout << "PlaylistJournal::compact - snapshot not written, keeping the journal" << std::endl;
+        changesSinceCompaction = 0;
+        compactionPending = false;
+        return;
+    }
+
+    journalStream.reset();
+    journalFile.deleteFile();
+    changesSinceCompaction = 0;
+    compactionPending = false;
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    PlaylistJournal.h
+    Created: 19 Oct 2026 6:20:14pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Thirdparty/nlohmann/json.hpp"
+
+/** Crash-safe persistence of the playlist without rewriting it on every change.
+
+    Every change is appended to a journal file by a background thread, one
+    JSON line per track set or erased. Every so often the thread hands every
+    change since open to the snapshot writer and empties the journal once the
+    snapshot is safely on disk. Replaying the journal again over a snapshot
+    that already holds it gives the same playlist, and a line torn by a crash
+    is dropped. **/
+class PlaylistJournal : private Thread
+{
+public:
+    /** Entry per track name, null when the track was erased **/
+    using Changes = std::map<std::string, nlohmann::json>;
+
+    /** Writes a new snapshot with the changes applied on the writer thread,
+    returns false to keep the journal until the next try **/
+    using SnapshotWriter = std::function<bool(const Changes& changes)>;
+
+    PlaylistJournal();
+    ~PlaylistJournal() override;
+
+    /** Replay the journal and start recording. Returns the changes the journal
+    held, to be applied over the last snapshot **/
+    Changes open(const File& journalFile, SnapshotWriter snapshotWriter);
+
+    /** Stop the writer, write what is left and a last snapshot. Call before
+    whatever the snapshot writer reads from goes away **/
+    void close();
+
+    /** Store the whole entry of a track **/
+    void recordSet(const std::string& trackName, const nlohmann::json& entry);
+    void recordErase(const std::string& trackName);
+
+    /** Changes recorded between beginBatch and endBatch are written together,
+    batches can nest **/
+    void beginBatch();
+    void endBatch();
+
+private:
+    struct Change
+    {
+        std::string trackName;
+        nlohmann::json entry;   // null when the track was erased
+    };
+
+    void run() override;
+
+    /** Append the queued changes to the journal, on the writer thread **/
+    void writePending();
+
+    /** Write a snapshot and empty the journal, on the writer thread **/
+    void compact();
+
+    File journalFile;
+    SnapshotWriter writeSnapshot;
+    bool isOpen = false;
+
+    CriticalSection queueLock;
+    std::vector<Change> queued;
+    int batchDepth = 0;
+
+    //only touched by the writer thread once open returned
+    Changes changes;
+    std::unique_ptr<FileOutputStream> journalStream;
+    int changesSinceCompaction = 0;
+    bool compactionPending = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistJournal)
+};
@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.cpp
+    Created: 20 Oct 2026 3:52:06am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PreviewPlayer.h"
+#include "CachedTrackSource.h"
+#include <cmath>
+
+namespace
+{
+    //decoded before the preview starts, the cache reads ahead of the playhead from there
+    constexpr double startSeconds = 3.0;
+}
+
+PreviewPlayer::PreviewPlayer(AudioFormatManager& _formatManager, DecodedBlockCache& _blockCache)
+    : formatManager(_formatManager), blockCache(_blockCache)
+{
+}
+
+PreviewPlayer::~PreviewPlayer()
+{
+    openPool.removeAllJobs(true, 4000);
+    cancelPendingUpdate();
+    transportSource.setSource(nullptr);
+}
+
+void PreviewPlayer::play(const File& file)
+{
+    previewFile = file;
+    opening = true;
+    int serial = ++requestSerial;
+
+    openPool.removeAllJobs(false, 0);
+    openPool.addJob([this, file, serial, weakThis = WeakReference<PreviewPlayer>(this)]
+    {
+        std::shared_ptr<PositionableAudioSource> newSource;
+        double sampleRate = 0.0;
+
+        auto track = blockCache.openTrack(file);
+        std::unique_ptr<AudioFormatReader> reader(formatManager.createReaderFor(file));
+        if (track != nullptr && reader != nullptr)
+        {
+            //blocks already cached are only looked up, a new track is decoded here
+            int numBlocks = jmin(track->getNumBlocks(), static_cast<int>(std::ceil(
+                startSeconds * track->getSampleRate() / DecodedBlockCache::blockSize)));
+            for (int block = 0; block < numBlocks; ++block)
+                blockCache.getBlock(*track, block);
+
+            sampleRate = track->getSampleRate();
+            newSource = std::make_shared<CachedTrackSource>(blockCache, track, reader.release());
+        }
+
+        MessageManager::callAsync([weakThis, serial, newSource, sampleRate]
+        {
+            //stopped or another track asked for since
+            if (weakThis == nullptr || serial != weakThis->requestSerial)
+                return;
+
+            if (newSource != nullptr)
+                weakThis->start(newSource, sampleRate);
+            else
+                weakThis->stop();
+        });
+    });
+}
+
+void PreviewPlayer::start(std::shared_ptr<PositionableAudioSource> newSource, double sampleRate)
+{
+    transportSource.setSource(nullptr);
+    source = std::move(newSource);
+    transportSource.setSource(source.get(), 0, nullptr, sampleRate);
+    transportSource.start();
+    active = true;
+    opening = false;
+
+    std::cout << "PreviewPlayer::start - " << previewFile.getFileName() << std::endl;
+    if (onChange != nullptr)
+        onChange();
+}
+
+void PreviewPlayer::stop()
+{
+    ++requestSerial;
+    previewFile = File();
+    opening = false;
+
+    active = false;
+    transportSource.stop();
+    transportSource.setSource(nullptr);
+    source.reset();
+
+    if (onChange != nullptr)
+        onChange();
+}
+
+void PreviewPlayer::handleAsyncUpdate()
+{
+    //a preview started since is playing and one being opened isn't there yet, both stay
+    if (source != nullptr && !opening && !transportSource.isPlaying())
+        stop();
+}
+
+bool PreviewPlayer::isPreviewing(const File& file) const
+{
+    return file == previewFile && isPreviewing();
+}
+
+bool PreviewPlayer::isPreviewing() const
+{
+    return opening || transportSource.isPlaying();
+}
+
+//==============================================================================
+void PreviewPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void PreviewPlayer::releaseResources()
+{
+    transportSource.releaseResources();
+}
+
+void PreviewPlayer::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    if (!isActive())
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    transportSource.getNextAudioBlock(bufferToFill);
+
+    //the transport stops itself at the end of the track, the row showing Stop is told
+    if (!transportSource.isPlaying())
+        triggerAsyncUpdate();
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    PreviewPlayer.h
+    Created: 20 Oct 2026 3:52:06am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "DecodedBlockCache.h"
+
+/** Auditions a playlist track without taking a deck. The track is read
+    through the DecodedBlockCache like a deck reads it, opened on a
+    background thread with its first seconds decoded before it starts, so a
+    track the waveform, Auto-DJ or an earlier preview already read starts at
+    once and no file is opened on the message or audio thread.
+
+    Renders stereo; where it goes, the cue output or under the mix, is up to
+    whoever pulls it. While nothing is auditioned isActive is false and
+    nothing needs to be rendered. **/
+class PreviewPlayer : public AudioSource,
+                      private AsyncUpdater
+{
+public:
+    /** Called on the message thread when a preview starts, fails, is stopped
+    or plays to the end **/
+    std::function<void()> onChange;
+
+    PreviewPlayer(AudioFormatManager& formatManager, DecodedBlockCache& blockCache);
+    ~PreviewPlayer() override;
+
+    /** Open the file in the background and play it from the start, replacing
+    any preview playing **/
+    void play(const File& file);
+    void stop();
+
+    /** True while file is being opened or playing **/
+    bool isPreviewing(const File& file) const;
+
+    /** True while any file is being opened or playing **/
+    bool isPreviewing() const;
+
+    /** Whether there is anything to render, read on the audio thread **/
+    bool isActive() const { return active.load() && transportSource.isPlaying(); }
+
+    //==============================================================================
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+private:
+    /** Swap to a track opened in the background and play it, on the message thread **/
+    void start(std::shared_ptr<PositionableAudioSource> newSource, double sampleRate);
+
+    /** Let go of a preview that played to the end, triggered by the audio thread **/
+    void handleAsyncUpdate() override;
+
+    AudioFormatManager& formatManager;
+    DecodedBlockCache& blockCache;
+
+    //one file at a time, a newer preview drops an older one still waiting
+    ThreadPool openPool{ 1 };
+
+    //file asked for and the request it belongs to, only touched on the message thread
+    File previewFile;
+    int requestSerial = 0;
+    bool opening = false;
+
+    std::shared_ptr<PositionableAudioSource> source;
+    AudioTransportSource transportSource;
+    std::atomic<bool> active{ false };
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (PreviewPlayer)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreviewPlayer)
+};
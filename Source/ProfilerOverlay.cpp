@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.cpp
+    Created: 20 Oct 2026 5:06:12am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ProfilerOverlay.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr double windowMs = 1000.0;
+    constexpr int refreshHz = 4;
+    constexpr int rowHeight = 16;
+}
+
+ProfilerOverlay::ProfilerOverlay()
+{
+    //opaque so refreshing it doesn't repaint the decks under it and skew what it shows
+    setOpaque(true);
+    setInterceptsMouseClicks(false, false);
+    setVisible(false);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    stopTimer();
+}
+
+void ProfilerOverlay::setActive(bool shouldBeActive)
+{
+    PaintProfiler::getInstance().setEnabled(shouldBeActive);
+    setVisible(shouldBeActive);
+    if (shouldBeActive)
+    {
+        toFront(false);
+        startTimerHz(refreshHz);
+    }
+    else
+    {
+        stopTimer();
+        summaries.clear();
+    }
+}
+
+void ProfilerOverlay::timerCallback()
+{
+    summaries = PaintProfiler::getInstance().summarise(windowMs);
+
+    //grouped by kind, the slowest first
+    std::sort(summaries.begin(), summaries.end(), [](const PaintProfiler::Summary& a, const PaintProfiler::Summary& b)
+    {
+        if (a.kind != b.kind)
+            return a.kind < b.kind;
+        return a.maxMs > b.maxMs;
+    });
+    repaint();
+}
+
+void ProfilerOverlay::paint(Graphics& g)
+{
+    g.fillAll(Colour(0xFF101010));
+    g.setColour(Colours::grey);
+    g.drawRect(getLocalBounds(), 1);
+
+    auto area = getLocalBounds().reduced(6);
+    g.setFont(13.0f);
+    g.setColour(Colours::lightgreen);
+    g.drawText("Last second - F12 hides, shift+F12 exports", area.removeFromTop(rowHeight), Justification::centredLeft);
+
+    int nameWidth = area.getWidth() / 2;
+    int columnWidth = (area.getWidth() - nameWidth) / 3;
+    auto drawRow = [&](const String& name, const String& count, const String& mean, const String& worst)
+    {
+        auto row = area.removeFromTop(rowHeight);
+        g.drawText(name, row.removeFromLeft(nameWidth), Justification::centredLeft);
+        g.drawText(count, row.removeFromLeft(columnWidth), Justification::centredRight);
+        g.drawText(mean, row.removeFromLeft(columnWidth), Justification::centredRight);
+        g.drawText(worst, row.removeFromLeft(columnWidth), Justification::centredRight);
+    };
+
+    g.setColour(Colours::grey);
+    drawRow("", "per second", "mean ms", "worst ms");
+
+    for (const auto& summary : summaries)
+    {
+        if (area.getHeight() < rowHeight)
+            break;
+
+        String name(summary.name);
+        switch (summary.kind)
+        {
+            case PaintProfiler::Kind::paint:
+                g.setColour(Colours::whitesmoke);
+                break;
+            case PaintProfiler::Kind::call:
+                g.setColour(Colours::orange);
+                break;
+            case PaintProfiler::Kind::timerLag:
+                g.setColour(Colours::whitesmoke);
+                name << " lag";
+                break;
+            case PaintProfiler::Kind::stall:
+                g.setColour(Colours::red);
+                name << " stalled";
+                break;
+        }
+
+        //over the last second the count is the rate
+        drawRow(name, String(summary.count), String(summary.meanMs, 2), String(summary.maxMs, 2));
+    }
+
+    if (summaries.empty())
+    {
+        g.setColour(Colours::grey);
+        g.drawText("nothing painted yet", area.removeFromTop(rowHeight), Justification::centredLeft);
+    }
+}
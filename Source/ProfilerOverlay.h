@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    ProfilerOverlay.h
+    Created: 20 Oct 2026 5:06:12am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "PaintProfiler.h"
+
+/** Panel over the window with what the PaintProfiler saw in the last
+    second: paints per second and their mean and worst time per component,
+    load calls, the latest timer callbacks and message thread stalls.
+    Doesn't take mouse clicks, the window works as usual under it. **/
+class ProfilerOverlay : public Component,
+                        private Timer
+{
+public:
+    ProfilerOverlay();
+    ~ProfilerOverlay() override;
+
+    /** Show the overlay and start profiling, or hide it and stop **/
+    void setActive(bool shouldBeActive);
+    bool isActive() const { return isVisible(); }
+
+    void paint(Graphics& g) override;
+
+private:
+    void timerCallback() override;
+
+    //last second of the profiler, refreshed a few times a second
+    std::vector<PaintProfiler::Summary> summaries;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerOverlay)
+};
@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+    SearchIndex.cpp
+    Created: 19 Oct 2026 10:26:03pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SearchIndex.h"
+#include <algorithm>
+
+namespace
+{
+    uint32_t gramKey(std::string_view text, size_t i)
+    {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16)
+             | (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8)
+             | static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2]));
+    }
+
+    //the length goes in the top byte so "a" and "a\0" never collide
+    uint32_t prefixKey(std::string_view text, size_t i, size_t length)
+    {
+        uint32_t key = static_cast<uint32_t>(length) << 16;
+        key |= static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 8;
+        if (length > 1)
+            key |= static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1]));
+        return key;
+    }
+
+    void sortUnique(std::vector<uint32_t>& keys)
+    {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    }
+}
+
+void SearchIndex::add(TrackId id, const std::vector<std::string>& fields)
+{
+    //fields are joined with a separator so no trigram spans two of them
+    std::string text;
+    for (const auto& field : fields)
+    {
+        text += normalise(field);
+        text += '\n';
+    }
+
+    bool indexed = id >= 0 && id < static_cast<TrackId>(spans.size()) && spans[id].length > 0;
+    if (indexed && text.size() <= spans[id].length)
+    {
+        //retagged or re-imported, the text goes where the old one was
+        eraseKeys(id);
+        Span& span = spans[id];
+        arena.replace(span.offset, text.size(), text);
+        unusedBytes += span.length - text.size();
+        span.length = text.size();
+    }
+    else
+    {
+        remove(id);
+        if (id >= static_cast<TrackId>(spans.size()))
+            spans.resize(static_cast<size_t>(id) + 1);
+        spans[id] = { arena.size(), text.size() };
+        arena += text;
+    }
+
+    std::vector<uint32_t> gramKeys, prefixKeys;
+    collectKeys(text, gramKeys, prefixKeys);
+    for (uint32_t key : gramKeys)
+        insertId(grams[key], id);
+    for (uint32_t key : prefixKeys)
+        insertId(prefixes[key], id);
+
+    packIfSparse();
+}
+
+void SearchIndex::remove(TrackId id)
+{
+    if (id < 0 || id >= static_cast<TrackId>(spans.size()) || spans[id].length == 0)
+        return;
+
+    eraseKeys(id);
+    unusedBytes += spans[id].length;
+    spans[id] = {};
+    packIfSparse();
+}
+
+void SearchIndex::eraseKeys(TrackId id)
+{
+    std::vector<uint32_t> gramKeys, prefixKeys;
+    collectKeys(getText(id), gramKeys, prefixKeys);
+    for (uint32_t key : gramKeys)
+        eraseId(grams, key, id);
+    for (uint32_t key : prefixKeys)
+        eraseId(prefixes, key, id);
+}
+
+void SearchIndex::packIfSparse()
+{
+    //texts are packed again once half of the arena is left over from removed or shortened ones
+    if (unusedBytes <= arena.size() / 2)
+        return;
+
+    std::string packed;
+    packed.reserve(arena.size() - unusedBytes);
+    for (auto& span : spans)
+    {
+        size_t offset = packed.size();
+        packed.append(arena, span.offset, span.length);
+        span.offset = offset;
+    }
+    arena.swap(packed);
+    unusedBytes = 0;
+}
+
+void SearchIndex::clear()
+{
+    arena.clear();
+    spans.clear();
+    unusedBytes = 0;
+    grams.clear();
+    prefixes.clear();
+}
+
+std::vector<SearchIndex::TrackId> SearchIndex::search(const std::string& query) const
+{
+    std::string normalised = normalise(query);
+
+    std::vector<std::string> words;
+    std::vector<const Postings*> lists;
+    size_t begin = 0;
+    while (begin < normalised.size())
+    {
+        if (!isWordChar(static_cast<unsigned char>(normalised[begin])))
+        {
+            ++begin;
+            continue;
+        }
+
+        size_t end = begin;
+        while (end < normalised.size() && isWordChar(static_cast<unsigned char>(normalised[end])))
+            ++end;
+
+        std::string word = normalised.substr(begin, end - begin);
+        begin = end;
+
+        //short words are looked up as word prefixes, longer ones by their trigrams
+        if (word.size() < 3)
+        {
+            auto found = prefixes.find(prefixKey(word, 0, word.size()));
+            if (found == prefixes.end())
+                return {};
+            lists.push_back(&found->second);
+            continue;
+        }
+
+        for (size_t i = 0; i + 3 <= word.size(); ++i)
+        {
+            auto found = grams.find(gramKey(word, i));
+            if (found == grams.end())
+                return {};
+            lists.push_back(&found->second);
+        }
+
+        //a three character word is its own trigram, longer ones are checked at the end
+        if (word.size() > 3)
+            words.push_back(std::move(word));
+    }
+
+    if (lists.empty())
+        return {};
+
+    //start from the rarest key, every other list only filters it
+    std::sort(lists.begin(), lists.end(),
+              [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+
+    std::vector<TrackId> result(*lists.front());
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i)
+    {
+        const Postings& other = *lists[i];
+        auto searchFrom = other.begin();
+        result.erase(std::remove_if(result.begin(), result.end(), [&](TrackId id)
+            {
+                //galloping, the next match is usually a few entries on
+                size_t step = 1;
+                auto bound = searchFrom;
+                while (bound != other.end() && *bound < id)
+                {
+                    searchFrom = bound;
+                    bound = static_cast<size_t>(other.end() - bound) > step ? bound + static_cast<std::ptrdiff_t>(step)
+                                                                           : other.end();
+                    step *= 2;
+                }
+                searchFrom = std::lower_bound(searchFrom, bound, id);
+                return searchFrom == other.end() || *searchFrom != id;
+            }), result.end());
+    }
+
+    //all the trigrams of a word can be there without the word itself
+    if (!words.empty())
+    {
+        result.erase(std::remove_if(result.begin(), result.end(), [&](TrackId id)
+            {
+                std::string_view text = getText(id);
+                for (const auto& word : words)
+                {
+                    if (text.find(word) == std::string_view::npos)
+                        return true;
+                }
+                return false;
+            }), result.end());
+    }
+
+    return result;
+}
+
+//==============================================================================
+std::string SearchIndex::normalise(const std::string& text)
+{
+    //ASCII is folded, other UTF-8 bytes are kept as they are
+    std::string normalised(text);
+    for (auto& c : normalised)
+    {
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c - 'A' + 'a');
+    }
+    return normalised;
+}
+
+bool SearchIndex::isWordChar(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+void SearchIndex::collectKeys(std::string_view text, std::vector<uint32_t>& gramKeys,
+                              std::vector<uint32_t>& prefixKeys)
+{
+    for (size_t i = 0; i + 3 <= text.size(); ++i)
+    {
+        if (text[i] != '\n' && text[i + 1] != '\n' && text[i + 2] != '\n')
+            gramKeys.push_back(gramKey(text, i));
+    }
+
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        bool wordStart = isWordChar(static_cast<unsigned char>(text[i]))
+                      && (i == 0 || !isWordChar(static_cast<unsigned char>(text[i - 1])));
+        if (!wordStart)
+            continue;
+
+        prefixKeys.push_back(prefixKey(text, i, 1));
+        if (i + 1 < text.size() && isWordChar(static_cast<unsigned char>(text[i + 1])))
+            prefixKeys.push_back(prefixKey(text, i, 2));
+    }
+
+    sortUnique(gramKeys);
+    sortUnique(prefixKeys);
+}
+
+void SearchIndex::insertId(Postings& postings, TrackId id)
+{
+    //new tracks get the highest id, so this is nearly always an append
+    if (postings.empty() || postings.back() < id)
+        postings.push_back(id);
+    else
+        postings.insert(std::lower_bound(postings.begin(), postings.end(), id), id);
+}
+
+void SearchIndex::eraseId(std::unordered_map<uint32_t, Postings>& map, uint32_t key, TrackId id)
+{
+    auto found = map.find(key);
+    if (found == map.end())
+        return;
+
+    Postings& postings = found->second;
+    auto position = std::lower_bound(postings.begin(), postings.end(), id);
+    if (position != postings.end() && *position == id)
+        postings.erase(position);
+    if (postings.empty())
+        map.erase(found);
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    SearchIndex.h
+    Created: 19 Oct 2026 10:26:03pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** Case insensitive search over the text fields of the library.
+
+    Every three byte sequence of a track's fields points to the tracks that
+    contain it, so a word is looked up by intersecting a few sorted id lists
+    instead of scanning every title. Words of one or two characters are
+    matched against the start of words, through a second list per prefix.
+    Adding or removing a track only touches the lists of its own text. **/
+class SearchIndex
+{
+public:
+    using TrackId = int;
+
+    SearchIndex() = default;
+    ~SearchIndex() = default;
+
+    /** Index the fields of a track, replacing what was indexed for it **/
+    void add(TrackId id, const std::vector<std::string>& fields);
+    void remove(TrackId id);
+    void clear();
+
+    /** Ids, ascending, of the tracks with every word of the query somewhere
+    in their fields. A query without words matches nothing **/
+    std::vector<TrackId> search(const std::string& query) const;
+
+private:
+    using Postings = std::vector<TrackId>;
+
+    static std::string normalise(const std::string& text);
+    static bool isWordChar(unsigned char c);
+
+    /** Keys of every trigram and word prefix in text, sorted and unique **/
+    static void collectKeys(std::string_view text, std::vector<uint32_t>& gramKeys,
+                            std::vector<uint32_t>& prefixKeys);
+
+    /** Take a track out of the postings of its text, its span stays **/
+    void eraseKeys(TrackId id);
+
+    /** Pack the texts together once most of the arena is left over **/
+    void packIfSparse();
+
+    static void insertId(Postings& postings, TrackId id);
+    static void eraseId(std::unordered_map<uint32_t, Postings>& map, uint32_t key, TrackId id);
+
+    std::string_view getText(TrackId id) const { return std::string_view(arena).substr(spans[id].offset, spans[id].length); }
+
+    struct Span
+    {
+        size_t offset = 0;
+        size_t length = 0;      // 0 when the track isn't indexed
+    };
+
+    //normalised fields of every indexed track, back to back in id order so
+    //checking the candidates of a search reads memory mostly forwards. A
+    //track indexed again reuses its span when the new text fits in it
+    std::string arena;
+    std::vector<Span> spans;
+    //bytes of the arena no span covers, packed away once they are half of it
+    size_t unusedBytes = 0;
+
+    std::unordered_map<uint32_t, Postings> grams;
+    std::unordered_map<uint32_t, Postings> prefixes;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SearchIndex)
+};
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    SeekPrefetcher.cpp
+    Created: 19 Oct 2026 3:02:41pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SeekPrefetcher.h"
+
+namespace
+{
+    //about 45 seconds of stereo audio at 44.1kHz
+    constexpr size_t defaultMemoryBudget = 64 * 1024 * 1024;
+
+    //a jump needs this much decoded audio ahead, the reader seeks once it runs out
+    constexpr double minimumLeadSeconds = 1.0;
+
+    //how long the worker sleeps when every target is covered
+    constexpr int idleWaitMs = 100;
+}
+
+SeekPrefetcher::SeekPrefetcher(const LoopingAudioSource& playheadToFollow)
+    : Thread("SeekPrefetcher"),
+      playhead(playheadToFollow),
+      memoryBudget(defaultMemoryBudget)
+{
+    startThread();
+}
+
+SeekPrefetcher::~SeekPrefetcher()
+{
+    stopThread(2000);
+}
+
+void SeekPrefetcher::setTrack(std::unique_ptr<AudioFormatReader> newReader)
+{
+    std::shared_ptr<AudioFormatReader> oldReader = std::move(newReader);
+    {
+        //a decode of the previous track carries on with its own copy of the reader
+        const ScopedLock sl(cacheLock);
+        std::swap(reader, oldReader);
+        ++trackGeneration;
+        sampleRate = reader != nullptr ? reader->sampleRate : 0.0;
+        lengthInSamples = reader != nullptr ? reader->lengthInSamples : 0;
+
+        entries.clear();
+        cueTargets.clear();
+        hoverTarget = -1;
+        memoryUsage = 0;
+    }
+
+    notify();
+}
+
+void SeekPrefetcher::setCueTargets(const std::vector<int64>& cues)
+{
+    {
+        const ScopedLock sl(cacheLock);
+        cueTargets = cues;
+    }
+    notify();
+}
+
+void SeekPrefetcher::setHoverTarget(int64 samplePos)
+{
+    {
+        const ScopedLock sl(cacheLock);
+        hoverTarget = samplePos;
+    }
+    notify();
+}
+
+SeekPrefetcher::WindowPtr SeekPrefetcher::findWindow(int64 samplePos)
+{
+    const ScopedLock sl(cacheLock);
+
+    //the window with the most audio after samplePos keeps the reader still the longest
+    Entry* best = nullptr;
+    for (auto& entry : entries)
+    {
+        if (covers(*entry.window, samplePos)
+            && (best == nullptr || entry.window->getEndSample() > best->window->getEndSample()))
+        {
+            best = &entry;
+        }
+    }
+
+    if (best == nullptr)
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    best->lastUsed = ++useCounter;
+    return best->window;
+}
+
+void SeekPrefetcher::setMemoryBudget(size_t bytes)
+{
+    const ScopedLock sl(cacheLock);
+    memoryBudget = bytes;
+
+    //anything may go when the budget shrinks, cues included
+    makeRoom(0, Priority::anything);
+}
+
+size_t SeekPrefetcher::getMemoryUsage() const
+{
+    const ScopedLock sl(cacheLock);
+    return memoryUsage;
+}
+
+//==============================================================================
+void SeekPrefetcher::run()
+{
+    while (!threadShouldExit())
+    {
+        if (!prefetchNext())
+            wait(idleWaitMs);
+    }
+}
+
+bool SeekPrefetcher::prefetchNext()
+{
+    std::shared_ptr<AudioFormatReader> trackReader;
+    uint32 generation = 0;
+    Target missing{};
+    bool found = false;
+    int64 start = 0;
+    int64 end = 0;
+    {
+        const ScopedLock sl(cacheLock);
+        if (reader == nullptr)
+            return false;
+
+        trackReader = reader;
+        generation = trackGeneration;
+
+        //re-rank every window by the most important target it still covers
+        for (auto& entry : entries)
+            entry.priority = Priority::none;
+
+        for (const auto& target : collectTargets())
+        {
+            bool covered = false;
+            for (auto& entry : entries)
+            {
+                if (covers(*entry.window, target.samplePos))
+                {
+                    entry.priority = jmax(entry.priority, target.priority);
+                    covered = true;
+                }
+            }
+
+            if (!covered && !found)
+            {
+                missing = target;
+                found = true;
+            }
+        }
+
+        if (!found)
+            return false;
+
+        start = jmax<int64>(0, missing.samplePos - static_cast<int64>(missing.secondsBefore * sampleRate));
+        end = jmin<int64>(lengthInSamples, missing.samplePos + static_cast<int64>(missing.secondsAfter * sampleRate));
+
+        size_t bytes = static_cast<size_t>(end - start) * jmin(2u, reader->numChannels) * sizeof(float);
+        if (!makeRoom(bytes, missing.priority))
+            return false;
+    }
+
+    //only this thread reads through the reader, setTrack just lets go of it
+    auto window = DecodedWindow::decode(*trackReader, start, end - start);
+    if (window == nullptr)
+        return false;
+
+    const ScopedLock sl(cacheLock);
+    if (generation != trackGeneration)
+        return true;
+
+    memoryUsage += getWindowBytes(*window);
+    entries.push_back({ std::move(window), missing.priority, ++useCounter });
+    return true;
+}
+
+std::vector<SeekPrefetcher::Target> SeekPrefetcher::collectTargets() const
+{
+    std::vector<Target> targets;
+    const int64 length = lengthInSamples;
+
+    for (int64 cue : cueTargets)
+    {
+        if (isPositiveAndBelow(cue, length))
+            targets.push_back({ cue, 0.0, 4.0, Priority::cue });
+    }
+
+    if (isPositiveAndBelow(hoverTarget, length))
+        targets.push_back({ hoverTarget, 0.5, 3.0, Priority::hover });
+
+    //small nudges back and forth around where the track is playing
+    int64 position = playhead.getNextReadPosition();
+    if (isPositiveAndBelow(position, length))
+        targets.push_back({ position, 4.0, 4.0, Priority::playhead });
+
+    targets.push_back({ 0, 0.0, 4.0, Priority::trackStart });
+    return targets;
+}
+
+bool SeekPrefetcher::covers(const DecodedWindow& window, int64 samplePos) const
+{
+    if (!window.contains(samplePos))
+        return false;
+
+    int64 lead = static_cast<int64>(minimumLeadSeconds * sampleRate);
+    return window.getEndSample() - samplePos >= lead || window.getEndSample() >= lengthInSamples;
+}
+
+bool SeekPrefetcher::makeRoom(size_t bytes, Priority priority)
+{
+    //don't throw anything away unless it frees enough
+    size_t evictable = 0;
+    for (const auto& entry : entries)
+    {
+        if (entry.priority < priority)
+            evictable += getWindowBytes(*entry.window);
+    }
+
+    if (memoryUsage - evictable + bytes > memoryBudget)
+        return false;
+
+    while (memoryUsage + bytes > memoryBudget)
+    {
+        //least important first, the least recently used among equals
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->priority >= priority)
+                continue;
+
+            if (victim == entries.end() || it->priority < victim->priority
+                || (it->priority == victim->priority && it->lastUsed < victim->lastUsed))
+            {
+                victim = it;
+            }
+        }
+
+        if (victim == entries.end())
+            return false;
+
+        //a window the audio thread still plays from lives on in the LoopingAudioSource
+        memoryUsage -= getWindowBytes(*victim->window);
+        entries.erase(victim);
+    }
+    return true;
+}
+
+size_t SeekPrefetcher::getWindowBytes(const DecodedWindow& window)
+{
+    return static_cast<size_t>(window.samples.getNumChannels()) * window.samples.getNumSamples() * sizeof(float);
+}
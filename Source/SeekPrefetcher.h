@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    SeekPrefetcher.h
+    Created: 19 Oct 2026 3:02:41pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LoopingAudioSource.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/** Keeps decoded windows of the loaded track where a seek is likely to land:
+    the hot cues, the spot the mouse hovers over on the waveform, the playhead
+    and the start of the track. A seek that lands in a window becomes a pointer
+    swap in the LoopingAudioSource instead of a seek of the file reader.
+
+    Decoding runs on a background thread with a reader of its own, and no lock is
+    held while it decodes: a window of a track that was swapped out meanwhile is
+    dropped when it is done. The cache is
+    bounded by a memory budget and evicts the least useful, least recently used
+    window first. **/
+class SeekPrefetcher : private Thread
+{
+public:
+    using WindowPtr = LoopingAudioSource::WindowPtr;
+
+    /** The playhead of playhead is polled to keep the windows around it fresh **/
+    explicit SeekPrefetcher(const LoopingAudioSource& playhead);
+    ~SeekPrefetcher() override;
+
+    /** Reader of the newly loaded track, nullptr to unload. Drops every window,
+    never waits for a decode of the previous track **/
+    void setTrack(std::unique_ptr<AudioFormatReader> newReader);
+
+    /** Sample positions of the hot cues, their windows stay until the cue goes **/
+    void setCueTargets(const std::vector<int64>& cues);
+
+    /** Where a click on the waveform would land, -1 once the mouse left it **/
+    void setHoverTarget(int64 samplePos);
+
+    /** Window holding samplePos with enough audio after it to be worth a jump,
+    nullptr on a miss. Counted in the hit and miss statistics **/
+    WindowPtr findWindow(int64 samplePos);
+
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryUsage() const;
+
+    int getHits() const { return hits.load(); }
+    int getMisses() const { return misses.load(); }
+
+private:
+    //a window is worth as much as the most important target it covers,
+    //nothing ranks as high as anything so makeRoom can evict it all
+    enum class Priority { none = 0, trackStart, playhead, hover, cue, anything };
+
+    struct Target
+    {
+        int64 samplePos;
+        double secondsBefore;
+        double secondsAfter;
+        Priority priority;
+    };
+
+    struct Entry
+    {
+        WindowPtr window;
+        Priority priority;
+        uint32 lastUsed;
+    };
+
+    void run() override;
+
+    /** Decode the most important target no window covers yet, false when there was nothing to do **/
+    bool prefetchNext();
+
+    /** Targets in decreasing priority, call with the cache lock held **/
+    std::vector<Target> collectTargets() const;
+
+    /** True when the window holds samplePos and at least a second after it, or the rest of the track **/
+    bool covers(const DecodedWindow& window, int64 samplePos) const;
+
+    /** Evict windows less important than priority until bytes fit, false if they can't.
+    Call with the cache lock held **/
+    bool makeRoom(size_t bytes, Priority priority);
+
+    static size_t getWindowBytes(const DecodedWindow& window);
+
+    const LoopingAudioSource& playhead;
+
+    //only held to look windows up or swap them, never while decoding
+    CriticalSection cacheLock;
+    //the worker decodes from a copy of the pointer, the old reader lives until it is done
+    std::shared_ptr<AudioFormatReader> reader;
+    //bumped by setTrack, a window decoded for an older track is dropped
+    uint32 trackGeneration = 0;
+    std::atomic<double> sampleRate{ 0.0 };
+    std::atomic<int64> lengthInSamples{ 0 };
+    std::vector<Entry> entries;
+    std::vector<int64> cueTargets;
+    int64 hoverTarget = -1;
+    size_t memoryUsage = 0;
+    size_t memoryBudget;
+    uint32 useCounter = 0;
+
+    std::atomic<int> hits{ 0 };
+    std::atomic<int> misses{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SeekPrefetcher)
+};
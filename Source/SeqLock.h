@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    SeqLock.h
+    Created: 20 Oct 2026 5:41:20am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/** A value written by one thread and read by any, without locks. The
+    writer never waits, which is what the audio thread needs; a reader that
+    lands on a write in progress reads again, the writer only copies a few
+    words so that is rare and short.
+
+    The value is kept as relaxed atomic words so a torn read is detected by
+    the sequence number instead of being a data race. **/
+template <typename ValueType>
+class SeqLock
+{
+public:
+    static_assert(std::is_trivially_copyable<ValueType>::value, "the value is copied word by word");
+
+    SeqLock()
+    {
+        for (auto& word : words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    /** Publish a new value. One writer only, never blocks or allocates **/
+    void write(const ValueType& value) noexcept
+    {
+        uint64 copy[numWords] = {};
+        std::memcpy(copy, &value, sizeof(ValueType));
+
+        //odd while the words change
+        uint32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < numWords; ++i)
+            words[i].store(copy[i], std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /** The last value written, all zero before the first write **/
+    ValueType read() const noexcept
+    {
+        uint64 copy[numWords];
+        for (;;)
+        {
+            uint32 before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+                continue;
+
+            for (size_t i = 0; i < numWords; ++i)
+                copy[i] = words[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                break;
+        }
+
+        ValueType value;
+        std::memcpy(&value, copy, sizeof(ValueType));
+        return value;
+    }
+
+private:
+    static constexpr size_t numWords = (sizeof(ValueType) + sizeof(uint64) - 1) / sizeof(uint64);
+
+    std::atomic<uint32> sequence{ 0 };
+    std::atomic<uint64> words[numWords];
+
+    JUCE_DECLARE_NON_COPYABLE (SeqLock)
+};
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    SyncEngine.cpp
+    Created: 19 Oct 2026 11:37:52am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include "SyncEngine.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    //critically damped loop settling in about a second
+    constexpr double timeConstant = 0.5;
+    constexpr double proportionalGain = 2.0 / timeConstant;
+    constexpr double integralGain = 1.0 / (timeConstant * timeConstant);
+
+    //never bend the follower by more than this, keeps pitch changes inaudible
+    constexpr double maxCorrection = 0.04;
+}
+
+void SyncEngine::prepare(double sampleRate)
+{
+    if (sampleRate > 0.0)
+        this->sampleRate = sampleRate;
+
+    reset();
+}
+
+void SyncEngine::reset()
+{
+    integral = 0.0;
+    phaseErrorMs = 0.0;
+}
+
+double SyncEngine::process(const DeckTiming& leader, const DeckTiming& follower, int numSamples)
+{
+    if (! leader.playing || ! leader.hasGrid || ! follower.hasGrid
+        || leader.bpm <= 0.0 || follower.bpm <= 0.0 || leader.speed <= 0.0)
+    {
+        reset();
+        return follower.speed;
+    }
+
+    //same tempo in beats per second of real time
+    double leaderBeatsPerSecond = leader.bpm * leader.speed / 60.0;
+    double targetRatio = leader.bpm * leader.speed / follower.bpm;
+
+    //phase error wrapped to half a beat either way, in seconds
+    double beatError = leader.beatPosition - follower.beatPosition;
+    beatError -= std::round(beatError);
+    double error = beatError / leaderBeatsPerSecond;
+    phaseErrorMs = error * 1000.0;
+
+    double correction = proportionalGain * error + integralGain * integral;
+    if (std::abs(correction) < maxCorrection)
+    {
+        //integrate only while not clamped so a big initial error can't wind up
+        integral += error * numSamples / sampleRate;
+    }
+
+    correction = std::clamp(correction, -maxCorrection, maxCorrection);
+    return targetRatio * (1.0 + correction);
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    SyncEngine.h
+    Created: 19 Oct 2026 11:37:52am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/** Snapshot of a deck taken at the start of an audio block **/
+struct DeckTiming
+{
+    bool playing = false;
+    bool hasGrid = false;
+    double beatPosition = 0.0;  // continuous beat number at the playhead
+    double bpm = 0.0;           // tempo of the grid at the playhead
+    double speed = 1.0;         // resampling ratio the deck plays at
+};
+
+/** Phase locked loop that keeps a follower deck on the beat of a leader deck.
+
+    The follower's ratio is the tempo ratio of the two beat grids, corrected
+    every block by a PI controller on the phase error, so nothing but the
+    resampling ratio changes and no extra audio is decoded. **/
+class SyncEngine
+{
+    public:
+        /** Sample rate of the audio device, sets the block duration **/
+        void prepare(double sampleRate);
+
+        /** Forget the controller state, call when sync is switched on **/
+        void reset();
+
+        /** Resampling ratio for the follower's next block. Returns the
+        follower's own speed when either deck can't be synced **/
+        double process(const DeckTiming& leader, const DeckTiming& follower, int numSamples);
+
+        /** Phase error of the last block in milliseconds, positive when the
+        follower is behind **/
+        double getPhaseErrorMs() const { return phaseErrorMs; }
+
+    private:
+        double sampleRate = 44100.0;
+        double integral = 0.0;
+        double phaseErrorMs = 0.0;
+};
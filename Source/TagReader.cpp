@@ -0,0 +1,673 @@
+/*
+  ==============================================================================
+
+    TagReader.cpp
+    Created: 20 Oct 2026 1:26:08am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TagReader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    //rows scrolled past long ago aren't worth opening anymore
+    constexpr size_t maxQueued = 256;
+
+    //how often tags read are handed to the message thread
+    constexpr int batchIntervalMs = 100;
+
+    //sizes from the file are checked against these before anything is allocated
+    constexpr uint32 maxTextSize = 1 << 16;
+    constexpr uint32 maxBlockSize = 16 << 20;
+
+    //enough for a long run of pictures and empty packets in an ogg file
+    constexpr int maxOggPages = 64;
+    constexpr int maxChunks = 64;
+
+    uint32 readBigEndian(const uint8* bytes, int numBytes)
+    {
+        uint32 value = 0;
+        for (int i = 0; i < numBytes; ++i)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    uint32 readLittleEndian(const uint8* bytes, int numBytes)
+    {
+        uint32 value = 0;
+        for (int i = numBytes; --i >= 0;)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    //ID3v2 sizes use 7 bits of each byte
+    uint32 readSyncSafe(const uint8* bytes)
+    {
+        return (uint32(bytes[0] & 0x7f) << 21) | (uint32(bytes[1] & 0x7f) << 14)
+             | (uint32(bytes[2] & 0x7f) << 7) | uint32(bytes[3] & 0x7f);
+    }
+
+    bool readBytes(InputStream& in, void* destination, uint32 size)
+    {
+        return in.read(destination, static_cast<int>(size)) == static_cast<int>(size);
+    }
+
+    bool readBlock(InputStream& in, std::vector<uint8>& block, uint32 size)
+    {
+        if (size > maxBlockSize || size > in.getTotalLength() - in.getPosition())
+            return false;
+
+        block.resize(size);
+        return size == 0 || readBytes(in, block.data(), size);
+    }
+
+    //==============================================================================
+    void appendUTF8(std::string& text, uint32 c)
+    {
+        if (c < 0x80)
+        {
+            text += static_cast<char>(c);
+        }
+        else if (c < 0x800)
+        {
+            text += static_cast<char>(0xc0 | (c >> 6));
+            text += static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000)
+        {
+            text += static_cast<char>(0xe0 | (c >> 12));
+            text += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            text += static_cast<char>(0x80 | (c & 0x3f));
+        }
+        else
+        {
+            text += static_cast<char>(0xf0 | (c >> 18));
+            text += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            text += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            text += static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+
+    //text fields end at the first null, ID3v2.4 separates several values with one
+    std::string fromLatin1(const uint8* data, size_t size)
+    {
+        std::string text;
+        for (size_t i = 0; i < size && data[i] != 0; ++i)
+            appendUTF8(text, data[i]);
+        return text;
+    }
+
+    std::string fromUTF16(const uint8* data, size_t size, bool bigEndian)
+    {
+        std::string text;
+        for (size_t i = 0; i + 1 < size; i += 2)
+        {
+            uint32 c = bigEndian ? readBigEndian(data + i, 2) : readLittleEndian(data + i, 2);
+            if (c == 0)
+                break;
+
+            //a surrogate pair makes one character outside the basic plane
+            if (c >= 0xd800 && c < 0xdc00 && i + 3 < size)
+            {
+                uint32 low = bigEndian ? readBigEndian(data + i + 2, 2) : readLittleEndian(data + i + 2, 2);
+                if (low >= 0xdc00 && low < 0xe000)
+                {
+                    c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                    i += 2;
+                }
+            }
+            appendUTF8(text, c);
+        }
+        return text;
+    }
+
+    bool isValidUTF8(const uint8* data, size_t size)
+    {
+        for (size_t i = 0; i < size;)
+        {
+            int extra = data[i] < 0x80 ? 0 : (data[i] & 0xe0) == 0xc0 ? 1 : (data[i] & 0xf0) == 0xe0 ? 2
+                      : (data[i] & 0xf8) == 0xf0 ? 3 : -1;
+            if (extra < 0 || static_cast<size_t>(extra) >= size - i)
+                return false;
+            for (int k = 1; k <= extra; ++k)
+            {
+                if ((data[i + static_cast<size_t>(k)] & 0xc0) != 0x80)
+                    return false;
+            }
+            i += static_cast<size_t>(extra) + 1;
+        }
+        return true;
+    }
+
+    //RIFF INFO has no encoding, newer taggers write UTF-8 and older ones Latin-1
+    std::string fromUTF8OrLatin1(const uint8* data, size_t size)
+    {
+        size_t length = 0;
+        while (length < size && data[length] != 0)
+            ++length;
+
+        if (isValidUTF8(data, length))
+            return std::string(reinterpret_cast<const char*>(data), length);
+        return fromLatin1(data, length);
+    }
+
+    std::string trimmed(const std::string& text)
+    {
+        size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos)
+            return {};
+        return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+    //==============================================================================
+    enum class Field { none, artist, title, bpm, key };
+
+    bool isComplete(const TrackTags& tags)
+    {
+        return !tags.artist.empty() && !tags.title.empty() && tags.bpm > 0.0 && !tags.key.empty();
+    }
+
+    /** The first value found for a field is kept **/
+    void setField(TrackTags& tags, Field field, const std::string& value)
+    {
+        std::string text = trimmed(value);
+        if (text.empty())
+            return;
+
+        switch (field)
+        {
+            case Field::artist:
+                if (tags.artist.empty())
+                    tags.artist = text;
+                break;
+            case Field::title:
+                if (tags.title.empty())
+                    tags.title = text;
+                break;
+            case Field::bpm:
+                if (tags.bpm <= 0.0)
+                {
+                    //written as "128", "128.00" or "128,5"
+                    std::replace(text.begin(), text.end(), ',', '.');
+                    double bpm = std::strtod(text.c_str(), nullptr);
+                    if (bpm > 0.0 && bpm < 1000.0)
+                        tags.bpm = bpm;
+                }
+                break;
+            case Field::key:
+                if (tags.key.empty())
+                    tags.key = text;
+                break;
+            case Field::none:
+                break;
+        }
+    }
+
+    //==============================================================================
+    Field getID3Field(const char* id, int idLength)
+    {
+        std::string name(id, static_cast<size_t>(idLength));
+        if (name == "TPE1" || name == "TP1")  return Field::artist;
+        if (name == "TIT2" || name == "TT2")  return Field::title;
+        if (name == "TBPM" || name == "TBP")  return Field::bpm;
+        if (name == "TKEY" || name == "TKE")  return Field::key;
+        return Field::none;
+    }
+
+    //0xff 0x00 stands for 0xff, so no byte pattern in a tag looks like an mpeg frame
+    void removeUnsynchronisation(std::vector<uint8>& data)
+    {
+        size_t out = 0;
+        for (size_t in = 0; in < data.size(); ++in)
+        {
+            data[out++] = data[in];
+            if (data[in] == 0xff && in + 1 < data.size() && data[in + 1] == 0x00)
+                ++in;
+        }
+        data.resize(out);
+    }
+
+    std::string decodeID3Text(const std::vector<uint8>& frame)
+    {
+        if (frame.empty())
+            return {};
+
+        const uint8* text = frame.data() + 1;
+        size_t size = frame.size() - 1;
+        switch (frame[0])
+        {
+            case 0:
+                return fromLatin1(text, size);
+            case 1:
+            {
+                //UTF-16 with a byte order mark, little endian without one
+                bool bigEndian = size >= 2 && text[0] == 0xfe && text[1] == 0xff;
+                bool hasBom = size >= 2 && ((text[0] == 0xfe && text[1] == 0xff) || (text[0] == 0xff && text[1] == 0xfe));
+                return hasBom ? fromUTF16(text + 2, size - 2, bigEndian) : fromUTF16(text, size, bigEndian);
+            }
+            case 2:
+                return fromUTF16(text, size, true);
+            case 3:
+                return fromUTF8OrLatin1(text, size);
+            default:
+                return {};
+        }
+    }
+
+    /** Parse the ID3v2 tag at the position of in, in is left after it **/
+    void readID3v2(InputStream& in, TrackTags& tags)
+    {
+        uint8 header[10];
+        int64 start = in.getPosition();
+        if (!readBytes(in, header, sizeof(header)) || std::memcmp(header, "ID3", 3) != 0)
+            return;
+
+        const int version = header[3];
+        const uint8 flags = header[5];
+        const uint32 size = readSyncSafe(header + 6);
+        const int64 tagEnd = start + 10 + size + ((version == 4 && (flags & 0x10)) ? 10 : 0);
+
+        //2.2 compression was never specified
+        if (version < 2 || version > 4 || (version == 2 && (flags & 0x40)))
+        {
+            in.setPosition(tagEnd);
+            return;
+        }
+
+        //unsynchronisation before 2.4 covers the whole tag, which is read first to undo it
+        std::vector<uint8> whole;
+        std::unique_ptr<MemoryInputStream> memory;
+        InputStream* source = &in;
+        int64 end = start + 10 + size;
+        if ((flags & 0x80) && version < 4)
+        {
+            if (!readBlock(in, whole, size))
+                return;
+            removeUnsynchronisation(whole);
+            memory = std::make_unique<MemoryInputStream>(whole.data(), whole.size(), false);
+            source = memory.get();
+            end = static_cast<int64>(whole.size());
+        }
+
+        if (version >= 3 && (flags & 0x40))
+        {
+            uint8 extended[4];
+            if (!readBytes(*source, extended, 4))
+                return;
+            //2.4 counts the size bytes themselves, 2.3 doesn't
+            uint32 extendedSize = version == 4 ? readSyncSafe(extended) : readBigEndian(extended, 4) + 4;
+            source->setPosition(source->getPosition() + extendedSize - 4);
+        }
+
+        const int idLength = version == 2 ? 3 : 4;
+        const int frameHeaderSize = version == 2 ? 6 : 10;
+        std::vector<uint8> frame;
+        while (source->getPosition() + frameHeaderSize <= end && !isComplete(tags))
+        {
+            uint8 frameHeader[10];
+            if (!readBytes(*source, frameHeader, static_cast<uint32>(frameHeaderSize)) || frameHeader[0] == 0)
+                break;  // padding
+
+            uint32 frameSize = version == 2 ? readBigEndian(frameHeader + 3, 3)
+                             : version == 3 ? readBigEndian(frameHeader + 4, 4)
+                                            : readSyncSafe(frameHeader + 4);
+            int64 frameEnd = source->getPosition() + frameSize;
+            if (frameEnd > end)
+                break;
+
+            Field field = getID3Field(reinterpret_cast<const char*>(frameHeader), idLength);
+            const uint8 format = version == 2 ? 0 : frameHeader[9];
+            bool skipped = field == Field::none || frameSize > maxTextSize
+                        || (version == 3 && (format & 0xc0))     // compressed, encrypted
+                        || (version == 4 && (format & 0x0c));
+            if (!skipped && readBlock(*source, frame, frameSize))
+            {
+                if (version == 3 && (format & 0x20) && !frame.empty())
+                    frame.erase(frame.begin());                     // group id
+                if (version == 4 && (format & 0x02))
+                    removeUnsynchronisation(frame);
+                if (version == 4 && (format & 0x01))
+                    frame.erase(frame.begin(), frame.begin() + jmin<std::ptrdiff_t>(4, static_cast<std::ptrdiff_t>(frame.size())));
+                setField(tags, field, decodeID3Text(frame));
+            }
+            source->setPosition(frameEnd);
+        }
+
+        in.setPosition(tagEnd);
+    }
+
+    //==============================================================================
+    Field getVorbisField(const std::string& name)
+    {
+        std::string upper(name);
+        for (auto& c : upper)
+        {
+            if (c >= 'a' && c <= 'z')
+                c = static_cast<char>(c - 'a' + 'A');
+        }
+
+        if (upper == "ARTIST")                       return Field::artist;
+        if (upper == "TITLE")                        return Field::title;
+        if (upper == "BPM" || upper == "TEMPO")      return Field::bpm;
+        if (upper == "INITIALKEY" || upper == "KEY") return Field::key;
+        return Field::none;
+    }
+
+    /** Parse a Vorbis comment block: vendor, then NAME=value strings, lengths little endian **/
+    void readVorbisComment(const uint8* data, size_t size, TrackTags& tags)
+    {
+        size_t position = 0;
+        auto readLength = [&](uint32& length)
+        {
+            if (size - position < 4)
+                return false;
+            length = readLittleEndian(data + position, 4);
+            position += 4;
+            return length <= size - position;
+        };
+
+        uint32 vendorLength, count;
+        if (!readLength(vendorLength))
+            return;
+        position += vendorLength;
+        if (size - position < 4)
+            return;
+        count = readLittleEndian(data + position, 4);
+        position += 4;
+
+        for (uint32 i = 0; i < count && !isComplete(tags); ++i)
+        {
+            uint32 length;
+            if (!readLength(length))
+                return;
+
+            std::string comment(reinterpret_cast<const char*>(data + position), length);
+            position += length;
+
+            size_t equals = comment.find('=');
+            if (equals != std::string::npos)
+                setField(tags, getVorbisField(comment.substr(0, equals)), comment.substr(equals + 1));
+        }
+    }
+
+    /** Metadata blocks after the fLaC marker, only the comment block is read **/
+    void readFlac(InputStream& in, TrackTags& tags)
+    {
+        std::vector<uint8> block;
+        for (int blocks = 0; blocks < maxChunks; ++blocks)
+        {
+            uint8 header[4];
+            if (!readBytes(in, header, 4))
+                return;
+
+            const bool last = (header[0] & 0x80) != 0;
+            const int type = header[0] & 0x7f;
+            const uint32 length = readBigEndian(header + 1, 3);
+            if (type == 4)
+            {
+                if (readBlock(in, block, length))
+                    readVorbisComment(block.data(), block.size(), tags);
+                return;
+            }
+
+            if (last)
+                return;
+            in.setPosition(in.getPosition() + length);
+        }
+    }
+
+    /** The comment header is the second packet of an ogg vorbis or opus stream **/
+    void readOgg(InputStream& in, TrackTags& tags)
+    {
+        std::vector<uint8> packet;
+        std::vector<uint8> segment;
+        int packetIndex = 0;
+
+        for (int pages = 0; pages < maxOggPages; ++pages)
+        {
+            uint8 header[27];
+            uint8 lacing[255];
+            if (!readBytes(in, header, sizeof(header)) || std::memcmp(header, "OggS", 4) != 0
+                || !readBytes(in, lacing, header[26]))
+                return;
+
+            for (int i = 0; i < header[26]; ++i)
+            {
+                if (!readBlock(in, segment, lacing[i]))
+                    return;
+                packet.insert(packet.end(), segment.begin(), segment.end());
+                if (packet.size() > maxBlockSize)
+                    return;
+
+                //a segment shorter than 255 bytes ends its packet
+                if (lacing[i] == 255)
+                    continue;
+
+                if (packetIndex++ == 1)
+                {
+                    if (packet.size() >= 7 && std::memcmp(packet.data(), "\x03vorbis", 7) == 0)
+                        readVorbisComment(packet.data() + 7, packet.size() - 7, tags);
+                    else if (packet.size() >= 8 && std::memcmp(packet.data(), "OpusTags", 8) == 0)
+                        readVorbisComment(packet.data() + 8, packet.size() - 8, tags);
+                    return;
+                }
+                packet.clear();
+            }
+        }
+    }
+
+    //==============================================================================
+    /** Sub chunks of a LIST INFO chunk, the text is null terminated **/
+    void readRiffInfo(const std::vector<uint8>& list, TrackTags& tags)
+    {
+        for (size_t position = 4; position + 8 <= list.size();)
+        {
+            const uint8* chunk = list.data() + position;
+            uint32 size = readLittleEndian(chunk + 4, 4);
+            if (size > list.size() - position - 8)
+                return;
+
+            Field field = std::memcmp(chunk, "INAM", 4) == 0 ? Field::title
+                        : std::memcmp(chunk, "IART", 4) == 0 ? Field::artist
+                                                             : Field::none;
+            if (field != Field::none)
+                setField(tags, field, fromUTF8OrLatin1(chunk + 8, size));
+
+            position += 8 + size + (size & 1);
+        }
+    }
+
+    /** Chunks of a wav or aiff file, the audio chunk is stepped over **/
+    void readChunks(InputStream& in, TrackTags& tags, bool bigEndian)
+    {
+        std::vector<uint8> block;
+        for (int chunks = 0; chunks < maxChunks && !isComplete(tags); ++chunks)
+        {
+            uint8 header[8];
+            if (!readBytes(in, header, 8))
+                return;
+
+            uint32 size = bigEndian ? readBigEndian(header + 4, 4) : readLittleEndian(header + 4, 4);
+            int64 next = in.getPosition() + size + (size & 1);
+
+            if (std::memcmp(header, "id3 ", 4) == 0 || std::memcmp(header, "ID3 ", 4) == 0)
+            {
+                readID3v2(in, tags);
+            }
+            else if (!bigEndian && std::memcmp(header, "LIST", 4) == 0 && size >= 4)
+            {
+                if (size <= maxTextSize && readBlock(in, block, size) && std::memcmp(block.data(), "INFO", 4) == 0)
+                    readRiffInfo(block, tags);
+            }
+            else if (bigEndian && (std::memcmp(header, "NAME", 4) == 0 || std::memcmp(header, "AUTH", 4) == 0))
+            {
+                if (size <= maxTextSize && readBlock(in, block, size))
+                    setField(tags, header[0] == 'N' ? Field::title : Field::artist,
+                             fromUTF8OrLatin1(block.data(), block.size()));
+            }
+
+            if (next >= in.getTotalLength())
+                return;
+            in.setPosition(next);
+        }
+    }
+}
+
+//==============================================================================
+TagReader::TagReader()
+    : Thread("TagReader")
+{
+    startThread();
+}
+
+TagReader::~TagReader()
+{
+    stopTimer();
+    signalThreadShouldExit();
+    notify();
+    stopThread(2000);
+}
+
+void TagReader::request(TrackId id, const String& path)
+{
+    if (!requested.insert(id).second)
+        return;
+
+    {
+        const ScopedLock sl(lock);
+        queue.push_back({ id, path });
+
+        //the oldest request is for a row long gone, it is asked for again if it comes back
+        if (queue.size() > maxQueued)
+        {
+            requested.erase(queue.front().id);
+            queue.pop_front();
+        }
+    }
+
+    notify();
+    if (!isTimerRunning())
+        startTimer(batchIntervalMs);
+}
+
+bool TagReader::readTags(const File& file, TrackTags& tags)
+{
+    FileInputStream fileStream(file);
+    if (fileStream.failedToOpen())
+        return false;
+
+    //the tags are small reads close together, one buffer covers most of them
+    BufferedInputStream in(fileStream, 16384);
+
+    uint8 magic[12] = {};
+    in.read(magic, sizeof(magic));
+    in.setPosition(0);
+
+    if (std::memcmp(magic, "ID3", 3) == 0)
+    {
+        readID3v2(in, tags);
+
+        //flac files with an id3 tag in front of them exist
+        uint8 marker[4] = {};
+        if (in.read(marker, 4) == 4 && std::memcmp(marker, "fLaC", 4) == 0)
+            readFlac(in, tags);
+    }
+    else if (std::memcmp(magic, "fLaC", 4) == 0)
+    {
+        in.setPosition(4);
+        readFlac(in, tags);
+    }
+    else if (std::memcmp(magic, "OggS", 4) == 0)
+    {
+        readOgg(in, tags);
+    }
+    else if (std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WAVE", 4) == 0)
+    {
+        in.setPosition(12);
+        readChunks(in, tags, false);
+    }
+    else if (std::memcmp(magic, "FORM", 4) == 0
+             && (std::memcmp(magic + 8, "AIFF", 4) == 0 || std::memcmp(magic + 8, "AIFC", 4) == 0))
+    {
+        in.setPosition(12);
+        readChunks(in, tags, true);
+    }
+
+    return true;
+}
+
+//==============================================================================
+void TagReader::run()
+{
+    while (!threadShouldExit())
+    {
+        Request next;
+        {
+            const ScopedLock sl(lock);
+            if (!queue.empty())
+            {
+                //the rows painted last are the ones on screen now
+                next = queue.back();
+                queue.pop_back();
+            }
+            else
+            {
+                next.id = -1;
+            }
+        }
+
+        if (next.id < 0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        Result result{ next.id, {}, false };
+        result.opened = readTags(File(next.path), result.tags);
+
+        const ScopedLock sl(lock);
+        results.push_back(std::move(result));
+    }
+}
+
+void TagReader::timerCallback()
+{
+    std::vector<Result> read;
+    bool idle;
+    {
+        const ScopedLock sl(lock);
+        read.swap(results);
+        idle = queue.empty();
+    }
+
+    if (idle && read.empty())
+    {
+        stopTimer();
+        return;
+    }
+
+    std::vector<std::pair<TrackId, TrackTags>> tags;
+    tags.reserve(read.size());
+    for (auto& result : read)
+    {
+        //once stored the track has its tags, a file edited since can be asked for again;
+        //one that can't be opened stays asked for, it isn't tried again this session
+        if (result.opened)
+        {
+            requested.erase(result.id);
+            tags.emplace_back(result.id, std::move(result.tags));
+        }
+        else
+            std::cout << "TagReader::timerCallback - can't open the file of track " << result.id << std::endl;
+    }
+
+    if (!tags.empty() && onTagsRead != nullptr)
+        onTagsRead(tags);
+}
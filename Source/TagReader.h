@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    TagReader.h
+    Created: 20 Oct 2026 1:26:08am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <functional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "LibraryIndex.h"
+#include "TrackTable.h"
+
+/** Reads the artist, title, bpm and key tags of the tracks shown, on a
+    background thread, so the library is never held up by opening files.
+
+    Only the tags at the start of a file are parsed: ID3v2 (mp3, and the id3
+    chunk of wav and aiff), Vorbis comments (flac, ogg and opus) and RIFF
+    INFO (wav). Frames that aren't needed, pictures mostly, are skipped over
+    without being read, and the audio itself is never touched.
+
+    Rows ask for their tracks as they are painted. The latest asked for is
+    read first and the queue only keeps the last few hundred, so scrolling
+    through a big library reads what is on screen rather than everything
+    scrolled past. **/
+class TagReader : private Thread,
+                  private Timer
+{
+public:
+    using TrackId = TrackTable::TrackId;
+
+    /** Called on the message thread with the tags read since the last call **/
+    std::function<void(const std::vector<std::pair<TrackId, TrackTags>>& tags)> onTagsRead;
+
+    TagReader();
+    ~TagReader() override;
+
+    /** Queue the file of a track, does nothing for one queued or being read **/
+    void request(TrackId id, const String& path);
+
+    /** Read the tags of a file, false when it can't be opened. A file
+    without tags reads as empty tags **/
+    static bool readTags(const File& file, TrackTags& tags);
+
+private:
+    struct Request
+    {
+        TrackId id;
+        String path;
+    };
+
+    struct Result
+    {
+        TrackId id;
+        TrackTags tags;
+        bool opened;
+    };
+
+    void run() override;
+    void timerCallback() override;
+
+    //ids queued or being read and files that can't be opened, only touched on the message thread
+    std::unordered_set<TrackId> requested;
+
+    CriticalSection lock;
+    std::deque<Request> queue;
+    std::vector<Result> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TagReader)
+};
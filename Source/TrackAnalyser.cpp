@@ -0,0 +1,408 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 19 Oct 2026 10:02:48am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackAnalyser.h"
+#include <cmath>
+
+namespace
+{
+    //~11.6ms per onset frame at 44.1kHz
+    constexpr int hopSize = 512;
+    constexpr int hopsPerRead = 256;
+
+    //tempo range searched, wide enough for house, techno and dnb at half time
+    constexpr double minBpm = 70.0;
+    constexpr double maxBpm = 180.0;
+
+    //tempo changes are looked for every windowBeats beats
+    constexpr int windowBeats = 32;
+    constexpr double tempoChangeThreshold = 0.015;
+
+    /** Ask a running pool job if it should stop, so the pool can shut down quickly **/
+    bool shouldExit()
+    {
+        auto* job = ThreadPoolJob::getCurrentThreadPoolJob();
+        return job != nullptr && job->shouldExit();
+    }
+}
+
+TrackAnalyser::TrackAnalyser(DecodedBlockCache& _blockCache)
+    : blockCache(_blockCache)
+{
+}
+
+TrackAnalyser::~TrackAnalyser()
+{
+    analysisPool.removeAllJobs(true, 10000);
+}
+
+void TrackAnalyser::analyseAsync(const File& file, std::function<void(const BeatGrid&)> onComplete)
+{
+    analysisPool.addJob([this, file, onComplete]
+    {
+        BeatGrid grid;
+        //reuses blocks a deck already decoded, but doesn't fill the cache with
+        //every track of the playlist
+        auto track = blockCache.openTrack(file);
+        if (track != nullptr)
+        {
+            DecodedBlockReader reader(blockCache, track, false);
+            grid = detectBeatGrid(reader);
+            std::cout << "TrackAnalyser::analyseAsync - " << file.getFileName()
+                      << " bpm: " << grid.getBpmAt(0) << std::endl;
+        }
+
+        if (shouldExit())
+            return;
+
+        MessageManager::callAsync([grid, onComplete] { onComplete(grid); });
+    });
+}
+
+BeatGrid TrackAnalyser::detectBeatGrid(AudioFormatReader& reader)
+{
+    std::vector<float> onsets = computeOnsetEnvelope(reader);
+    double hopsPerSecond = reader.sampleRate / hopSize;
+
+    //need a few bars to say anything about the tempo
+    if (onsets.size() < static_cast<size_t>(hopsPerSecond * 10.0))
+        return {};
+
+    double period = estimatePeriod(onsets, hopsPerSecond);
+    if (period <= 0.0)
+        return {};
+
+    //local tempo of every window, close enough windows are merged into one
+    //tempo segment. A segment needs at least two windows so a single odd
+    //break doesn't bend the grid
+    struct Section { size_t begin; size_t end; double period; int numWindows; };
+    std::vector<Section> sections;
+    const size_t windowLength = static_cast<size_t>(period * windowBeats);
+
+    for (size_t begin = 0; begin + windowLength <= onsets.size(); begin += windowLength)
+    {
+        if (shouldExit())
+            return {};
+
+        double localPeriod = period;
+        float bestScore = -1.0f;
+        for (double candidate = period * 0.94; candidate <= period * 1.06; candidate += period * 0.002)
+        {
+            float score = 0.0f;
+            estimatePhase(onsets, candidate, begin, begin + windowLength, &score);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                localPeriod = candidate;
+            }
+        }
+
+        if (! sections.empty() && std::abs(localPeriod / sections.back().period - 1.0) < tempoChangeThreshold)
+        {
+            Section& section = sections.back();
+            section.period = (section.period * section.numWindows + localPeriod) / (section.numWindows + 1);
+            section.end = begin + windowLength;
+            ++section.numWindows;
+        }
+        else
+        {
+            sections.push_back({ begin, begin + windowLength, localPeriod, 1 });
+        }
+    }
+
+    for (size_t i = 0; i < sections.size(); )
+    {
+        if (sections[i].numWindows > 1 || sections.size() == 1)
+        {
+            ++i;
+            continue;
+        }
+
+        //fold short sections into a neighbour
+        size_t into = i > 0 ? i - 1 : i + 1;
+        sections[into].begin = jmin(sections[into].begin, sections[i].begin);
+        sections[into].end = jmax(sections[into].end, sections[i].end);
+        sections.erase(sections.begin() + static_cast<std::ptrdiff_t>(i));
+        i = 0;
+    }
+
+    if (sections.empty())
+        sections.push_back({ 0, onsets.size(), period, 1 });
+
+    sections.back().end = onsets.size();
+
+    //exact period and phase of every section from its onset peaks, chained
+    //into the grid so every tempo change starts on a beat
+    BeatGrid grid;
+    for (Section& section : sections)
+    {
+        double sectionPeriod = section.period;
+        double phase = estimatePhase(onsets, sectionPeriod, section.begin, section.end);
+        refineWithPeaks(onsets, sectionPeriod, phase, section.end);
+
+        //an onset frame covers a whole hop, on average the attack sits in its middle
+        double firstBeatSample = (phase + 0.5) * hopSize;
+
+        if (! grid.isValid())
+        {
+            grid = BeatGrid(reader.sampleRate, firstBeatSample, 60.0 * hopsPerSecond / sectionPeriod);
+        }
+        else
+        {
+            //the section starts on a window boundary, the real change is a beat
+            //where the old grid and the new one line up. That repeats every few
+            //beats, so the candidate whose joined grid hits the most onsets wins
+            double estimate = std::round(grid.getBeatPosition(firstBeatSample));
+            double changeBeat = estimate;
+            float bestScore = -1.0f;
+
+            auto onsetNear = [&onsets](double hop)
+            {
+                size_t centre = static_cast<size_t>(jmax(1.0, hop + 0.5));
+                if (centre + 1 >= onsets.size())
+                    return 0.0f;
+                return jmax(onsets[centre - 1], onsets[centre], onsets[centre + 1]);
+            };
+
+            for (double beat = estimate - windowBeats; beat <= estimate + windowBeats; beat += 1.0)
+            {
+                double changeSample = grid.getSampleForBeat(beat);
+                double offset = (changeSample - firstBeatSample) / (sectionPeriod * hopSize);
+                if (std::abs(offset - std::round(offset)) > 0.1)
+                    continue;
+
+                float score = 0.0f;
+                for (double b = estimate - windowBeats; b < estimate + windowBeats; b += 1.0)
+                {
+                    double sample = b < beat ? grid.getSampleForBeat(b)
+                                             : changeSample + (b - beat) * sectionPeriod * hopSize;
+                    score += onsetNear(sample / hopSize - 0.5);
+                }
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    changeBeat = beat;
+                }
+            }
+
+            //fit the tempo again from the change on, the first window was mixed
+            double changePhase = grid.getSampleForBeat(changeBeat) / hopSize - 0.5;
+            refineWithPeaks(onsets, sectionPeriod, changePhase, section.end);
+            grid.addTempoChange(static_cast<int64>(changeBeat), 60.0 * hopsPerSecond / sectionPeriod);
+        }
+    }
+
+    return grid;
+}
+
+std::vector<float> TrackAnalyser::computeOnsetEnvelope(AudioFormatReader& reader)
+{
+    std::vector<float> onsets;
+    if (reader.lengthInSamples <= 0 || reader.numChannels == 0)
+        return onsets;
+
+    const int numChannels = jmin(2, static_cast<int>(reader.numChannels));
+    const int samplesPerRead = hopSize * hopsPerRead;
+    AudioBuffer<float> buffer(numChannels, samplesPerRead);
+    onsets.reserve(static_cast<size_t>(reader.lengthInSamples / hopSize) + 1);
+
+    float previousSample = 0.0f;
+    float previousEnergy = 0.0f;
+
+    for (int64 pos = 0; pos + hopSize <= reader.lengthInSamples; pos += samplesPerRead)
+    {
+        if (shouldExit())
+            return {};
+
+        int numSamples = static_cast<int>(jmin<int64>(samplesPerRead, reader.lengthInSamples - pos));
+        reader.read(&buffer, 0, numSamples, pos, true, numChannels > 1);
+
+        const float* left = buffer.getReadPointer(0);
+        const float* right = buffer.getReadPointer(numChannels - 1);
+
+        for (int hopStart = 0; hopStart + hopSize <= numSamples; hopStart += hopSize)
+        {
+            //the first difference works as a cheap high pass, transients stand out
+            float energy = 0.0f;
+            for (int i = hopStart; i < hopStart + hopSize; ++i)
+            {
+                float mono = 0.5f * (left[i] + right[i]);
+                float diff = mono - previousSample;
+                energy += diff * diff;
+                previousSample = mono;
+            }
+
+            float logEnergy = std::log1p(1000.0f * energy / hopSize);
+            onsets.push_back(jmax(0.0f, logEnergy - previousEnergy));
+            previousEnergy = logEnergy;
+        }
+    }
+
+    return onsets;
+}
+
+double TrackAnalyser::estimatePeriod(const std::vector<float>& onsets, double hopsPerSecond)
+{
+    const size_t numOnsets = onsets.size();
+    const int minLag = static_cast<int>(std::floor(hopsPerSecond * 60.0 / maxBpm));
+    const int maxLag = static_cast<int>(std::ceil(hopsPerSecond * 60.0 / minBpm));
+    if (minLag < 2 || static_cast<size_t>(maxLag * 2) >= numOnsets)
+        return 0.0;
+
+    double mean = 0.0;
+    for (float onset : onsets)
+        mean += onset;
+    mean /= static_cast<double>(numOnsets);
+
+    std::vector<float> centred(numOnsets);
+    for (size_t i = 0; i < numOnsets; ++i)
+        centred[i] = static_cast<float>(onsets[i] - mean);
+
+    //autocorrelation up to twice the longest lag, the double lag backs up the
+    //single one and keeps us off half/double tempo
+    std::vector<double> acf(static_cast<size_t>(maxLag * 2 + 1), 0.0);
+    for (int lag = minLag; lag <= maxLag * 2; ++lag)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i + lag < numOnsets; ++i)
+            sum += centred[i] * centred[i + lag];
+        acf[lag] = sum / static_cast<double>(numOnsets - lag);
+    }
+
+    std::vector<double> scores(acf.size(), 0.0);
+    int bestLag = 0;
+    for (int lag = minLag; lag <= maxLag; ++lag)
+    {
+        //gently prefer tempos around 120 bpm
+        double bpm = 60.0 * hopsPerSecond / lag;
+        double octaves = std::log2(bpm / 120.0);
+        double weight = std::exp(-0.5 * octaves * octaves);
+        scores[lag] = (acf[lag] + 0.5 * acf[lag * 2]) * weight;
+
+        if (bestLag == 0 || scores[lag] > scores[bestLag])
+            bestLag = lag;
+    }
+
+    //parabolic peak interpolation, then a comb search over the whole track
+    //because one hop is still a couple of percent of tempo
+    double period = bestLag;
+    if (bestLag > minLag && bestLag < maxLag)
+    {
+        double a = scores[bestLag - 1], b = scores[bestLag], c = scores[bestLag + 1];
+        double denominator = a - 2.0 * b + c;
+        if (denominator < 0.0)
+            period += 0.5 * (a - c) / denominator;
+    }
+
+    double bestPeriod = period;
+    float bestScore = -1.0f;
+    for (double candidate = period - 1.0; candidate <= period + 1.0; candidate += 0.01)
+    {
+        float score = 0.0f;
+        estimatePhase(onsets, candidate, 0, numOnsets, &score);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestPeriod = candidate;
+        }
+    }
+    return bestPeriod;
+}
+
+double TrackAnalyser::estimatePhase(const std::vector<float>& onsets, double period,
+                                    size_t begin, size_t end, float* score)
+{
+    end = jmin(end, onsets.size());
+    const int numPhases = static_cast<int>(std::ceil(period));
+    if (numPhases <= 0 || begin + numPhases >= end)
+        return static_cast<double>(begin);
+
+    std::vector<float> phaseScores(static_cast<size_t>(numPhases), 0.0f);
+    for (int phase = 0; phase < numPhases; ++phase)
+    {
+        float sum = 0.0f;
+        int count = 0;
+        for (double pos = static_cast<double>(begin + phase); pos < end - 0.5; pos += period)
+        {
+            sum += onsets[static_cast<size_t>(pos + 0.5)];
+            ++count;
+        }
+        phaseScores[phase] = count > 0 ? sum / count : 0.0f;
+    }
+
+    int bestPhase = 0;
+    for (int phase = 1; phase < numPhases; ++phase)
+    {
+        if (phaseScores[phase] > phaseScores[bestPhase])
+            bestPhase = phase;
+    }
+
+    if (score != nullptr)
+        *score = phaseScores[bestPhase];
+
+    //sub hop refinement with the neighbouring phases
+    double a = phaseScores[(bestPhase + numPhases - 1) % numPhases];
+    double b = phaseScores[bestPhase];
+    double c = phaseScores[(bestPhase + 1) % numPhases];
+    double denominator = a - 2.0 * b + c;
+    double offset = denominator < 0.0 ? 0.5 * (a - c) / denominator : 0.0;
+
+    return jmax(0.0, static_cast<double>(begin) + bestPhase + offset);
+}
+
+void TrackAnalyser::refineWithPeaks(const std::vector<float>& onsets, double& period, double& phase, size_t end)
+{
+    end = jmin(end, onsets.size());
+    const int searchRadius = jmax(1, static_cast<int>(period / 4.0));
+    double sumWeight = 0.0, sumBeat = 0.0, sumPos = 0.0, sumBeatBeat = 0.0, sumBeatPos = 0.0;
+
+    for (int beat = 0; ; ++beat)
+    {
+        double predicted = phase + beat * period;
+        int centre = static_cast<int>(predicted + 0.5);
+        if (centre + searchRadius + 1 >= static_cast<int>(end))
+            break;
+
+        int peak = jmax(1, centre - searchRadius);
+        for (int i = peak + 1; i <= centre + searchRadius; ++i)
+        {
+            if (onsets[i] > onsets[peak])
+                peak = i;
+        }
+
+        double a = onsets[peak - 1], b = onsets[peak], c = onsets[peak + 1];
+        double denominator = a - 2.0 * b + c;
+        double pos = peak + (denominator < 0.0 ? 0.5 * (a - c) / denominator : 0.0);
+
+        //strong onsets count more, an empty break can't drag the fit around
+        double weight = b;
+        sumWeight += weight;
+        sumBeat += weight * beat;
+        sumPos += weight * pos;
+        sumBeatBeat += weight * beat * beat;
+        sumBeatPos += weight * beat * pos;
+    }
+
+    double denominator = sumWeight * sumBeatBeat - sumBeat * sumBeat;
+    if (sumWeight <= 0.0 || denominator <= 0.0)
+        return;
+
+    double fittedPeriod = (sumWeight * sumBeatPos - sumBeat * sumPos) / denominator;
+    double fittedPhase = (sumPos - fittedPeriod * sumBeat) / sumWeight;
+
+    //only accept small corrections, anything else means the peaks were noise
+    if (std::abs(fittedPeriod / period - 1.0) < 0.01 && std::abs(fittedPhase - phase) < period / 4.0)
+    {
+        period = fittedPeriod;
+        phase = jmax(0.0, fittedPhase);
+    }
+}
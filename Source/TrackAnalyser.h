@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.h
+    Created: 19 Oct 2026 10:02:48am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+#include "BeatGrid.h"
+#include "DecodedBlockCache.h"
+
+/** Offline track analysis. Decodes the whole file on a background thread and
+    hands the result back on the message thread, so nothing here ever runs at
+    playback time. **/
+class TrackAnalyser
+{
+public:
+    TrackAnalyser(DecodedBlockCache& blockCache);
+    ~TrackAnalyser();
+
+    /** Analyse the file on the background thread, onComplete is called
+    on the message thread with an empty grid if the file can't be read **/
+    void analyseAsync(const File& file, std::function<void(const BeatGrid&)> onComplete);
+
+    /** Decode the reader and estimate its beat grid. Blocking, never call it
+    from the message or the audio thread **/
+    static BeatGrid detectBeatGrid(AudioFormatReader& reader);
+
+private:
+    /** Onset strength per hop: positive change of the log energy of the
+    differentiated mono signal **/
+    static std::vector<float> computeOnsetEnvelope(AudioFormatReader& reader);
+
+    /** Beat period in hops, from the autocorrelation of the onset envelope
+    refined with a comb filter over the whole track **/
+    static double estimatePeriod(const std::vector<float>& onsets, double hopsPerSecond);
+
+    /** Best comb alignment in hops for the given period, score is optional **/
+    static double estimatePhase(const std::vector<float>& onsets, double period,
+                                size_t begin, size_t end, float* score = nullptr);
+
+    /** Least squares fit of the onset peaks closest to each predicted beat up
+    to end, tightens period and phase well below one hop **/
+    static void refineWithPeaks(const std::vector<float>& onsets, double& period,
+                                double& phase, size_t end);
+
+    DecodedBlockCache& blockCache;
+    ThreadPool analysisPool{ 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackAnalyser)
+};
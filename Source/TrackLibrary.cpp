@@ -0,0 +1,371 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.cpp
+    Created: 19 Oct 2026 8:15:37pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackLibrary.h"
+#include "Utilities.h"
+#include "ContentHash.h"
+#include "PlaylistFile.h"
+#include <algorithm>
+#include <set>
+
+namespace
+{
+    //records copied by the loader thread at a time
+    constexpr int loadChunkSize = 2048;
+
+    //chunks stored per timer tick, a few milliseconds of the message thread
+    constexpr int chunksPerTick = 2;
+    constexpr int loadIntervalMs = 10;
+
+    //tracks put in the search index per timer tick, it lags behind the table
+    //on a big library and catches up once the chunks are stored
+    constexpr double indexSliceMs = 4.0;
+}
+
+TrackLibrary::TrackLibrary()
+    : Thread("TrackLibrary loader")
+{
+}
+
+TrackLibrary::~TrackLibrary()
+{
+    stopTimer();
+    stopThread(4000);
+
+    //the last snapshot reads the index, so the journal goes first
+    closing = true;
+    journal.close();
+}
+
+void TrackLibrary::open(const File& dataFolder)
+{
+    indexFile = dataFolder.getChildFile("library.index");
+    File legacyFile = dataFolder.getChildFile("playlist.json");
+
+    //playlist.json from before the index is read once and written as the first index
+    if (!indexFile.existsAsFile() && legacyFile.existsAsFile())
+    {
+        std::vector<TrackInfo> tracks;
+        if (!PlaylistFile::read(legacyFile, [&tracks](TrackInfo&& track) { tracks.push_back(std::move(track)); }))
+            std::cout << "TrackLibrary::open - can't import all of playlist.json" << std::endl;
+
+        if (LibraryIndex::write(indexFile, std::move(tracks)))
+            std::cout << "TrackLibrary::open - imported playlist.json into " << indexFile.getFullPathName() << std::endl;
+    }
+
+    index.open(indexFile);
+    crates.open(dataFolder.getChildFile("crates.json"));
+    table.reserve(index.getNumTracks());
+
+    //same journal file as before the index, its lines are the playlist.json entries
+    replayed = journal.open(legacyFile.withFileExtension("journal"),
+        [this](const PlaylistJournal::Changes& changes) { return writeSnapshot(changes); });
+
+    loadStartMs = Time::getMillisecondCounterHiRes();
+    startThread();
+    startTimer(loadIntervalMs);
+}
+
+void TrackLibrary::run()
+{
+    //the index is read-only while open, the journal's writer thread may read it too
+    for (int begin = 0; begin < index.getNumTracks() && !threadShouldExit(); begin += loadChunkSize)
+    {
+        int end = jmin(begin + loadChunkSize, index.getNumTracks());
+        std::vector<TrackInfo> chunk;
+        chunk.reserve(static_cast<size_t>(end - begin));
+        for (int record = begin; record < end; ++record)
+            chunk.push_back(index.getTrack(record));
+
+        const ScopedLock sl(chunkLock);
+        chunks.push_back(std::move(chunk));
+    }
+
+    indexRead = true;
+}
+
+void TrackLibrary::timerCallback()
+{
+    //read before taking the chunks, the last chunk is queued before the flag is set
+    bool allRead = indexRead;
+
+    std::vector<std::vector<TrackInfo>> ready;
+    bool moreQueued;
+    {
+        const ScopedLock sl(chunkLock);
+        while (!chunks.empty() && static_cast<int>(ready.size()) < chunksPerTick)
+        {
+            ready.push_back(std::move(chunks.front()));
+            chunks.pop_front();
+        }
+        moreQueued = !chunks.empty();
+    }
+
+    for (const auto& chunk : ready)
+    {
+        for (const auto& track : chunk)
+            loadTrack(track);
+    }
+
+    if (allRead && !moreQueued && !tableLoaded)
+    {
+        //what is left of the journal are tracks added since the index was written
+        for (auto& [key, entry] : replayed)
+        {
+            if (!entry.is_null() && table.findTrack(key) < 0)
+                table.add(fromJSON(key, entry));
+        }
+        replayed.clear();
+        crates.resolve();
+        tableLoaded = true;
+    }
+
+    bool indexed = indexNextSlice();
+
+    if (tableLoaded && !indexed)
+    {
+        stopTimer();
+        loaded = true;
+        std::cout << "TrackLibrary::open - " << table.getNumTracks() << " tracks in "
+                  << Time::getMillisecondCounterHiRes() - loadStartMs << " ms" << std::endl;
+    }
+
+    if ((loaded || !ready.empty() || indexed) && onLoadProgress != nullptr)
+        onLoadProgress(loaded);
+}
+
+void TrackLibrary::loadTrack(const TrackInfo& track)
+{
+    std::string key = track.getKey();
+    if (table.findTrack(key) >= 0)
+        return;
+
+    auto change = replayed.find(key);
+    if (change == replayed.end())
+    {
+        table.add(track);
+        return;
+    }
+
+    //erased or changed since the index was written
+    if (!change->second.is_null())
+        table.add(fromJSON(key, change->second));
+    replayed.erase(change);
+}
+
+//==============================================================================
+TrackLibrary::TrackId TrackLibrary::addTrack(const TrackInfo& newTrack)
+{
+    //a track still to be loaded would be added twice
+    jassert(loaded);
+
+    TrackInfo track(newTrack);
+    TrackId id = table.findTrack(track.getKey());
+
+    //a track from before content hashes, found again by its path, takes its hash as key;
+    //a file edited in place does too, but what was analysed isn't in it anymore
+    bool edited = false;
+    if (id < 0 && track.contentHash != 0)
+    {
+        TrackId atPath = table.findTrackByPath(track.path);
+        if (atPath >= 0)
+        {
+            edited = table.getContentHash(atPath) != 0;
+            journal.recordErase(table.getKey(atPath));
+            crates.keysChanged();
+            id = atPath;
+        }
+    }
+
+    if (id >= 0)
+    {
+        //the same content moved or added again: keep its analysis and the date
+        //it was first added, take the new location
+        if (track.beatGrid.empty() && !edited)
+            track.beatGrid = table.getBeatGrid(id);
+        if (!track.tagsRead && !edited)
+        {
+            track.tags = table.getTags(id);
+            track.tagsRead = table.areTagsRead(id);
+        }
+        if (track.dateAdded == 0)
+            track.dateAdded = table.getDateAdded(id);
+        table.update(id, track);
+    }
+    else
+    {
+        if (track.dateAdded == 0)
+            track.dateAdded = Time::currentTimeMillis();
+        id = table.add(track);
+    }
+    indexForSearch(id);
+
+    journal.recordSet(track.getKey(), toJSON(track));
+    return id;
+}
+
+void TrackLibrary::removeTrack(TrackId id)
+{
+    if (!table.contains(id))
+        return;
+
+    journal.recordErase(table.getKey(id));
+    table.remove(id);
+    searchIndex.remove(id);
+    crates.tracksRemoved();
+}
+
+void TrackLibrary::setBeatGrid(TrackId id, const std::vector<double>& beatGrid)
+{
+    if (!table.contains(id))
+        return;
+
+    table.setBeatGrid(id, beatGrid);
+    journal.recordSet(table.getKey(id), toJSON(table.getTrack(id)));
+}
+
+void TrackLibrary::setTags(TrackId id, const TrackTags& tags)
+{
+    if (!table.contains(id))
+        return;
+
+    table.setTags(id, tags);
+    indexForSearch(id);
+    journal.recordSet(table.getKey(id), toJSON(table.getTrack(id)));
+}
+
+std::vector<TrackLibrary::TrackId> TrackLibrary::search(const String& query)
+{
+    if (query.trim().isEmpty())
+        return table.getIds();
+
+    return searchIndex.search(query.toStdString());
+}
+
+bool TrackLibrary::indexNextSlice()
+{
+    //ids are handed out in order, so the tracks still to index are the ones from firstUnindexed on
+    const std::vector<TrackId>& ids = table.getIds();
+    auto next = std::lower_bound(ids.begin(), ids.end(), firstUnindexed);
+    if (next == ids.end())
+        return false;
+
+    double start = Time::getMillisecondCounterHiRes();
+    for (; next != ids.end() && Time::getMillisecondCounterHiRes() - start < indexSliceMs; ++next)
+    {
+        indexForSearch(*next);
+        firstUnindexed = *next + 1;
+    }
+    return true;
+}
+
+void TrackLibrary::indexForSearch(TrackId id)
+{
+    //the file name is the title, so only the folders of the path are added
+    const std::string& path = table.getPath(id);
+    size_t separator = path.find_last_of("/\\");
+    std::string folders = separator != std::string::npos ? path.substr(0, separator) : std::string();
+    const TrackTags& tags = table.getTags(id);
+    searchIndex.add(id, { table.getTitle(id), tags.title, tags.artist, folders });
+}
+
+//==============================================================================
+bool TrackLibrary::exportPlaylist(const File& file) const
+{
+    const std::vector<TrackId>& ids = table.getIds();
+    return PlaylistFile::write(file, static_cast<int>(ids.size()),
+                               [this, &ids](int index) { return table.getTrack(ids[static_cast<size_t>(index)]); });
+}
+
+nlohmann::json TrackLibrary::toJSON(const TrackInfo& track)
+{
+    nlohmann::json entry;
+    entry["Title"] = track.title;
+    entry["Duration"] = Utilities::formatTotalTime(track.durationSeconds);
+    entry["DurationSeconds"] = track.durationSeconds;
+    entry["Path"] = track.path;
+    if (!track.beatGrid.empty())
+        entry["BeatGrid"] = track.beatGrid;
+    if (track.dateAdded > 0)
+        entry["DateAdded"] = track.dateAdded;
+    if (track.contentHash != 0)
+        entry["ContentHash"] = ContentHash::toString(track.contentHash);
+    if (track.tagsRead)
+    {
+        nlohmann::json tags;
+        tags["Artist"] = track.tags.artist;
+        tags["Title"] = track.tags.title;
+        tags["Key"] = track.tags.key;
+        tags["BPM"] = track.tags.bpm;
+        entry["Tags"] = tags;
+    }
+    return entry;
+}
+
+TrackInfo TrackLibrary::fromJSON(const std::string& key, const nlohmann::json& entry)
+{
+    TrackInfo track;
+    //older entries are keyed by their title and don't repeat it
+    track.title = entry.value("Title", key);
+    track.path = entry.value("Path", std::string{});
+    //playlist.json from older versions only has the formated duration
+    track.durationSeconds = entry.value("DurationSeconds",
+        Utilities::parseTotalTime(entry.value("Duration", std::string{})));
+    track.beatGrid = entry.value("BeatGrid", std::vector<double>{});
+    track.dateAdded = entry.value("DateAdded", static_cast<int64>(0));
+    track.contentHash = ContentHash::fromString(entry.value("ContentHash", std::string{}));
+    auto tags = entry.find("Tags");
+    if (tags != entry.end() && tags->is_object())
+    {
+        track.tags.artist = tags->value("Artist", std::string{});
+        track.tags.title = tags->value("Title", std::string{});
+        track.tags.key = tags->value("Key", std::string{});
+        track.tags.bpm = tags->value("BPM", 0.0);
+        track.tagsRead = true;
+    }
+    return track;
+}
+
+//==============================================================================
+bool TrackLibrary::writeSnapshot(const PlaylistJournal::Changes& changes)
+{
+    //the index is never changed while open, only the message thread's table is
+    std::vector<TrackInfo> tracks;
+    tracks.reserve(index.getNumTracks() + changes.size());
+    std::set<std::string> merged;
+
+    for (int slot = 0; slot < index.getNumTracks(); ++slot)
+    {
+        std::string key = TrackInfo::getKey(index.getTitle(slot), index.getContentHash(slot));
+        auto change = changes.find(key);
+        if (change == changes.end())
+        {
+            tracks.push_back(index.getTrack(slot));
+            continue;
+        }
+
+        merged.insert(key);
+        if (!change->second.is_null())
+            tracks.push_back(fromJSON(key, change->second));
+    }
+
+    for (auto& [key, entry] : changes)
+    {
+        if (!entry.is_null() && merged.count(key) == 0)
+            tracks.push_back(fromJSON(key, entry));
+    }
+
+    //Windows can't replace a mapped file, so the last snapshot unmaps it first
+    if (closing)
+        index.close();
+
+    return LibraryIndex::write(indexFile, std::move(tracks));
+}
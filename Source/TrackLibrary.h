@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    TrackLibrary.h
+    Created: 19 Oct 2026 8:15:37pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../Thirdparty/nlohmann/json.hpp"
+#include "LibraryIndex.h"
+#include "PlaylistJournal.h"
+#include "TrackTable.h"
+#include "SearchIndex.h"
+#include "CrateStore.h"
+
+/** The tracks of the playlist. The memory mapped LibraryIndex is copied
+    into a TrackTable by a background thread at open, in chunks the message
+    thread stores between paints, so the window and the decks don't wait for
+    a big library; changes are made to the table and go to the
+    PlaylistJournal, which folds them into a new index in the background.
+
+    JSON is only an import and export format, playlist.json from older
+    versions is imported into the index the first time. **/
+class TrackLibrary : private Thread,
+                     private Timer
+{
+public:
+    using TrackId = TrackTable::TrackId;
+
+    /** Called on the message thread after every chunk of tracks stored or
+    slice of them indexed for search, with finished set on the last one **/
+    std::function<void(bool finished)> onLoadProgress;
+
+    TrackLibrary();
+    ~TrackLibrary() override;
+
+    /** Map the index in dataFolder and start loading it, with the journal
+    applied over it. Tracks can be shown and removed as they arrive, tracks
+    are added once isLoaded **/
+    void open(const File& dataFolder);
+
+    bool isLoaded() const { return loaded; }
+
+    const TrackTable& getTable() const { return table; }
+
+    /** Crates of the library's tracks, resolved once it is loaded. Tracks
+    removed from the library leave their crates **/
+    CrateStore& getCrates() { return crates; }
+    const CrateStore& getCrates() const { return crates; }
+
+    /** Add the track, returns its id. A track with the key of one already in
+    the library replaces it, keeping its beat grid and date added, so a moved
+    file is linked again without being analysed again or having its tags read
+    again. A track with a new key at the path of one in the library is that
+    file edited, it takes the old row without its beat grid and tags. A track
+    without a date added gets the current time **/
+    TrackId addTrack(const TrackInfo& track);
+    void removeTrack(TrackId id);
+    void setBeatGrid(TrackId id, const std::vector<double>& beatGrid);
+
+    /** Cache what TagReader read from the track's file **/
+    void setTags(TrackId id, const TrackTags& tags);
+
+    /** Ids, ascending, of the tracks matching every word of the query, every
+    track for an empty one. The search index is built a slice per tick while
+    the library loads and kept up to date from then on, a search made before
+    it is loaded only finds the tracks indexed so far **/
+    std::vector<TrackId> search(const String& query);
+
+    /** Changes between the two are written to disk together **/
+    void beginBatch() { journal.beginBatch(); }
+    void endBatch() { journal.endBatch(); }
+
+    /** Write every track, in the library order, as a playlist file in the
+    format of its extension. Playlists are imported through LibraryImporter **/
+    bool exportPlaylist(const File& file) const;
+
+    /** Playlist entry in the playlist.json format, keyed by TrackInfo::getKey **/
+    static nlohmann::json toJSON(const TrackInfo& track);
+    static TrackInfo fromJSON(const std::string& key, const nlohmann::json& entry);
+
+private:
+    /** Copy the index records into chunks of tracks, on the loader thread **/
+    void run() override;
+
+    /** Store the chunks read so far, on the message thread **/
+    void timerCallback() override;
+
+    /** Store a track of the index, or the journal's version of it **/
+    void loadTrack(const TrackInfo& track);
+
+    /** Index the next tracks stored by the load for a few milliseconds,
+    false when every one of them already is **/
+    bool indexNextSlice();
+
+    /** Put the fields of a track in the search index, replacing what was there **/
+    void indexForSearch(TrackId id);
+
+    /** Merge the index and every change since open into a new index, on the journal's writer thread **/
+    bool writeSnapshot(const PlaylistJournal::Changes& changes);
+
+    File indexFile;
+
+    //read by the loader thread at open and by the journal's writer thread
+    LibraryIndex index;
+
+    TrackTable table;
+
+    //hold ids into the table, written with the tracks' keys
+    CrateStore crates{ table };
+
+    SearchIndex searchIndex;
+    //the tracks from this id on are stored by the load but not indexed yet
+    TrackId firstUnindexed = 0;
+
+    //the last snapshot unmaps the index before replacing it
+    std::atomic<bool> closing{ false };
+
+    //the journal's changes, until the index records they replace are loaded
+    PlaylistJournal::Changes replayed;
+
+    CriticalSection chunkLock;
+    std::deque<std::vector<TrackInfo>> chunks;
+    std::atomic<bool> indexRead{ false };
+    //every track is stored, the search index may still be catching up
+    bool tableLoaded = false;
+    bool loaded = false;
+    double loadStartMs = 0.0;
+
+    PlaylistJournal journal;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLibrary)
+};
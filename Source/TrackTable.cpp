@@ -0,0 +1,309 @@
+/*
+  ==============================================================================
+
+    TrackTable.cpp
+    Created: 19 Oct 2026 9:02:11pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackTable.h"
+#include "Utilities.h"
+#include <algorithm>
+
+namespace
+{
+    //ASCII folded, enough to keep upper and lower case names together
+    std::string foldCase(std::string text)
+    {
+        for (auto& c : text)
+        {
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+        return text;
+    }
+
+    String toText(const std::string& text)
+    {
+        return String::fromUTF8(text.data(), static_cast<int>(text.size()));
+    }
+}
+
+void TrackTable::reserve(int numTracks)
+{
+    titles.reserve(numTracks);
+    paths.reserve(numTracks);
+    durations.reserve(numTracks);
+    bpms.reserve(numTracks);
+    beatGrids.reserve(numTracks);
+    datesAdded.reserve(numTracks);
+    tags.reserve(numTracks);
+    tagsRead.reserve(numTracks);
+    titleKeys.reserve(numTracks);
+    artistKeys.reserve(numTracks);
+    musicalKeys.reserve(numTracks);
+    titleTexts.reserve(numTracks);
+    artistTexts.reserve(numTracks);
+    keyTexts.reserve(numTracks);
+    durationTexts.reserve(numTracks);
+    bpmTexts.reserve(numTracks);
+    dateAddedTexts.reserve(numTracks);
+    live.reserve(numTracks);
+    ids.reserve(numTracks);
+    contentHashes.reserve(numTracks);
+    idByKey.reserve(numTracks);
+    idByPath.reserve(numTracks);
+}
+
+TrackTable::TrackId TrackTable::add(const TrackInfo& track)
+{
+    TrackId id = static_cast<TrackId>(titles.size());
+    titles.push_back(track.title);
+    paths.push_back(track.path);
+    durations.push_back(track.durationSeconds);
+    bpms.push_back(0.0);
+    beatGrids.push_back(track.beatGrid);
+    datesAdded.push_back(track.dateAdded);
+    contentHashes.push_back(track.contentHash);
+    tags.push_back(track.tags);
+    tagsRead.push_back(track.tagsRead ? 1 : 0);
+    titleKeys.emplace_back();
+    artistKeys.emplace_back();
+    musicalKeys.emplace_back();
+    titleTexts.emplace_back();
+    artistTexts.emplace_back();
+    keyTexts.emplace_back();
+    durationTexts.emplace_back();
+    bpmTexts.emplace_back();
+    dateAddedTexts.emplace_back();
+    live.push_back(1);
+    format(id);
+
+    ids.push_back(id);
+    idByKey[track.getKey()] = id;
+    idByPath[track.path] = id;
+    resort(id);
+    return id;
+}
+
+void TrackTable::update(TrackId id, const TrackInfo& track)
+{
+    jassert(contains(id));
+    unsort(id);
+    idByKey.erase(getKey(id));
+    idByPath.erase(paths[id]);
+
+    titles[id] = track.title;
+    paths[id] = track.path;
+    durations[id] = track.durationSeconds;
+    beatGrids[id] = track.beatGrid;
+    datesAdded[id] = track.dateAdded;
+    contentHashes[id] = track.contentHash;
+    tags[id] = track.tags;
+    tagsRead[id] = track.tagsRead ? 1 : 0;
+    format(id);
+
+    idByKey[track.getKey()] = id;
+    idByPath[track.path] = id;
+    resort(id);
+}
+
+void TrackTable::setBeatGrid(TrackId id, const std::vector<double>& beatGrid)
+{
+    jassert(contains(id));
+    unsort(id);
+    beatGrids[id] = beatGrid;
+    format(id);
+    resort(id);
+}
+
+void TrackTable::setTags(TrackId id, const TrackTags& newTags)
+{
+    jassert(contains(id));
+    unsort(id);
+    tags[id] = newTags;
+    tagsRead[id] = 1;
+    format(id);
+    resort(id);
+}
+
+void TrackTable::remove(TrackId id)
+{
+    if (!contains(id))
+        return;
+
+    unsort(id);
+
+    //ids are ascending, the slot itself is kept so no other id moves
+    auto row = std::lower_bound(ids.begin(), ids.end(), id);
+    ids.erase(row);
+    idByKey.erase(getKey(id));
+    idByPath.erase(paths[id]);
+
+    live[id] = 0;
+    std::string().swap(paths[id]);
+    std::vector<double>().swap(beatGrids[id]);
+    tags[id] = TrackTags();
+    std::string().swap(titleKeys[id]);
+    std::string().swap(artistKeys[id]);
+    std::string().swap(musicalKeys[id]);
+    titleTexts[id] = String();
+    artistTexts[id] = String();
+    keyTexts[id] = String();
+    durationTexts[id] = String();
+    bpmTexts[id] = String();
+    dateAddedTexts[id] = String();
+}
+
+TrackTable::TrackId TrackTable::findTrack(const std::string& key) const
+{
+    auto found = idByKey.find(key);
+    return found != idByKey.end() ? found->second : -1;
+}
+
+TrackTable::TrackId TrackTable::findTrackByPath(const std::string& path) const
+{
+    auto found = idByPath.find(path);
+    return found != idByPath.end() ? found->second : -1;
+}
+
+TrackInfo TrackTable::getTrack(TrackId id) const
+{
+    TrackInfo track;
+    track.title = titles[id];
+    track.path = paths[id];
+    track.durationSeconds = durations[id];
+    track.beatGrid = beatGrids[id];
+    track.dateAdded = datesAdded[id];
+    track.contentHash = contentHashes[id];
+    track.tags = tags[id];
+    track.tagsRead = tagsRead[id] != 0;
+    return track;
+}
+
+void TrackTable::format(TrackId id)
+{
+    //BeatGrid::toArray starts with the sample rate, the first beat and the bpm
+    bpms[id] = beatGrids[id].size() >= 3 ? beatGrids[id][2] : tags[id].bpm;
+    const std::string& title = tags[id].title.empty() ? titles[id] : tags[id].title;
+    titleTexts[id] = toText(title);
+    artistTexts[id] = toText(tags[id].artist);
+    keyTexts[id] = toText(tags[id].key);
+    durationTexts[id] = String(Utilities::formatTotalTime(durations[id]));
+    bpmTexts[id] = bpms[id] > 0.0 ? String(bpms[id], 1) : String();
+    dateAddedTexts[id] = datesAdded[id] > 0 ? Time(datesAdded[id]).formatted("%Y-%m-%d") : String();
+
+    titleKeys[id] = foldCase(title);
+    artistKeys[id] = foldCase(tags[id].artist);
+    musicalKeys[id] = foldCase(tags[id].key);
+}
+
+//==============================================================================
+const std::vector<TrackTable::TrackId>& TrackTable::getSortedIds(SortColumn column) const
+{
+    int index = static_cast<int>(column);
+    if (!isSorted[index])
+    {
+        sortedIds[index] = ids;
+        std::sort(sortedIds[index].begin(), sortedIds[index].end(),
+                  [this, column](TrackId a, TrackId b) { return isBefore(column, a, b); });
+        isSorted[index] = true;
+    }
+    return sortedIds[index];
+}
+
+std::vector<TrackTable::TrackId> TrackTable::sortIds(const std::vector<TrackId>& idsToSort,
+                                                     SortColumn column, bool forwards) const
+{
+    const std::vector<TrackId>& order = getSortedIds(column);
+
+    std::vector<TrackId> sorted;
+    if (idsToSort.size() == ids.size())
+    {
+        sorted = order;
+    }
+    else
+    {
+        //one pass over the sorted ids keeps the ones asked for
+        std::vector<char> wanted(titles.size(), 0);
+        for (TrackId id : idsToSort)
+            wanted[id] = 1;
+
+        sorted.reserve(idsToSort.size());
+        for (TrackId id : order)
+        {
+            if (wanted[id])
+                sorted.push_back(id);
+        }
+    }
+
+    if (!forwards)
+        std::reverse(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+bool TrackTable::isBefore(SortColumn column, TrackId a, TrackId b) const
+{
+    switch (column)
+    {
+        case SortColumn::title:
+            if (titleKeys[a] != titleKeys[b])
+                return titleKeys[a] < titleKeys[b];
+            break;
+        case SortColumn::duration:
+            if (durations[a] != durations[b])
+                return durations[a] < durations[b];
+            break;
+        case SortColumn::bpm:
+            if (bpms[a] != bpms[b])
+                return bpms[a] < bpms[b];
+            break;
+        case SortColumn::dateAdded:
+            if (datesAdded[a] != datesAdded[b])
+                return datesAdded[a] < datesAdded[b];
+            break;
+        case SortColumn::artist:
+            if (artistKeys[a] != artistKeys[b])
+                return artistKeys[a] < artistKeys[b];
+            break;
+        case SortColumn::key:
+            if (musicalKeys[a] != musicalKeys[b])
+                return musicalKeys[a] < musicalKeys[b];
+            break;
+    }
+    return a < b;
+}
+
+void TrackTable::unsort(TrackId id)
+{
+    for (int index = 0; index < numSortColumns; ++index)
+    {
+        if (!isSorted[index])
+            continue;
+
+        auto column = static_cast<SortColumn>(index);
+        auto& order = sortedIds[index];
+        auto position = std::lower_bound(order.begin(), order.end(), id,
+                                         [this, column](TrackId a, TrackId b) { return isBefore(column, a, b); });
+        if (position != order.end() && *position == id)
+            order.erase(position);
+    }
+}
+
+void TrackTable::resort(TrackId id)
+{
+    for (int index = 0; index < numSortColumns; ++index)
+    {
+        if (!isSorted[index])
+            continue;
+
+        auto column = static_cast<SortColumn>(index);
+        auto& order = sortedIds[index];
+        order.insert(std::upper_bound(order.begin(), order.end(), id,
+                                      [this, column](TrackId a, TrackId b) { return isBefore(column, a, b); }),
+                     id);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    TrackTable.h
+    Created: 19 Oct 2026 9:02:11pm
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LibraryIndex.h"
+
+/** The library in memory, one array per field indexed by a track id.
+
+    Ids are handed out in order and never reused, so they stay valid while
+    rows are removed and can be held by background jobs. The display columns
+    are formatted once when a track is stored, painting a cell only reads an
+    array. Sort orders are kept as arrays of ids, built the first time a
+    column is sorted by and updated in place from then on. **/
+class TrackTable
+{
+public:
+    using TrackId = int;
+
+    enum class SortColumn { title, duration, bpm, dateAdded, artist, key };
+    static constexpr int numSortColumns = 6;
+
+    TrackTable() = default;
+    ~TrackTable() = default;
+
+    void reserve(int numTracks);
+
+    /** Store a new track at the end, returns its id **/
+    TrackId add(const TrackInfo& track);
+
+    /** Replace every field of a track, its id stays **/
+    void update(TrackId id, const TrackInfo& track);
+    void setBeatGrid(TrackId id, const std::vector<double>& beatGrid);
+    void setTags(TrackId id, const TrackTags& tags);
+    void remove(TrackId id);
+
+    bool contains(TrackId id) const { return isPositiveAndBelow(id, static_cast<int>(live.size())) && live[id]; }
+
+    /** Id of the track with this TrackInfo::getKey, -1 when there is none **/
+    TrackId findTrack(const std::string& key) const;
+    TrackId findTrackByPath(const std::string& path) const;
+
+    /** Ids of the tracks in the table, ascending **/
+    const std::vector<TrackId>& getIds() const { return ids; }
+    int getNumTracks() const { return static_cast<int>(ids.size()); }
+
+    const std::string& getTitle(TrackId id) const { return titles[id]; }
+    const std::string& getPath(TrackId id) const { return paths[id]; }
+    double getDuration(TrackId id) const { return durations[id]; }
+    /** Analysed bpm, the one in the tags until then **/
+    double getBpm(TrackId id) const { return bpms[id]; }
+    int64 getDateAdded(TrackId id) const { return datesAdded[id]; }
+    uint64 getContentHash(TrackId id) const { return contentHashes[id]; }
+    std::string getKey(TrackId id) const { return TrackInfo::getKey(titles[id], contentHashes[id]); }
+    bool hasBeatGrid(TrackId id) const { return !beatGrids[id].empty(); }
+    const std::vector<double>& getBeatGrid(TrackId id) const { return beatGrids[id]; }
+    const TrackTags& getTags(TrackId id) const { return tags[id]; }
+    bool areTagsRead(TrackId id) const { return tagsRead[id] != 0; }
+    TrackInfo getTrack(TrackId id) const;
+
+    /** Title tag, the file name without one **/
+    const String& getTitleText(TrackId id) const { return titleTexts[id]; }
+    const String& getArtistText(TrackId id) const { return artistTexts[id]; }
+    const String& getKeyText(TrackId id) const { return keyTexts[id]; }
+    const String& getDurationText(TrackId id) const { return durationTexts[id]; }
+    const String& getBpmText(TrackId id) const { return bpmTexts[id]; }
+    const String& getDateAddedText(TrackId id) const { return dateAddedTexts[id]; }
+
+    /** Every id sorted by the column, ascending with ties in id order **/
+    const std::vector<TrackId>& getSortedIds(SortColumn column) const;
+
+    /** Put ids, ascending, in the order of the column. Walks the sorted ids,
+    no key is compared **/
+    std::vector<TrackId> sortIds(const std::vector<TrackId>& ids, SortColumn column, bool forwards) const;
+
+private:
+    /** Fill the derived columns of a track from its stored fields **/
+    void format(TrackId id);
+
+    bool isBefore(SortColumn column, TrackId a, TrackId b) const;
+
+    /** Take a track out of the built sort orders before its keys change, and put it back after **/
+    void unsort(TrackId id);
+    void resort(TrackId id);
+
+    std::vector<std::string> titles;
+    std::vector<std::string> paths;
+    std::vector<double> durations;
+    std::vector<double> bpms;                   // from the beat grid or the tags, 0 without either
+    std::vector<std::vector<double>> beatGrids;
+    std::vector<int64> datesAdded;
+    std::vector<uint64> contentHashes;
+    std::vector<TrackTags> tags;
+    std::vector<char> tagsRead;
+    std::vector<std::string> titleKeys;         // lower case, sorted by
+    std::vector<std::string> artistKeys;
+    std::vector<std::string> musicalKeys;
+    std::vector<String> titleTexts;
+    std::vector<String> artistTexts;
+    std::vector<String> keyTexts;
+    std::vector<String> durationTexts;
+    std::vector<String> bpmTexts;
+    std::vector<String> dateAddedTexts;
+    std::vector<char> live;
+
+    std::vector<TrackId> ids;
+    std::unordered_map<std::string, TrackId> idByKey;
+    std::unordered_map<std::string, TrackId> idByPath;
+
+    mutable std::array<std::vector<TrackId>, numSortColumns> sortedIds;
+    mutable std::array<bool, numSortColumns> isSorted{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackTable)
+};
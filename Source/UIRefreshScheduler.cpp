@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    UIRefreshScheduler.cpp
+    Created: 20 Oct 2026 5:41:20am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "UIRefreshScheduler.h"
+#include <algorithm>
+
+namespace
+{
+    //how often a hidden window is checked for coming back
+    constexpr int throttledHz = 4;
+}
+
+UIRefreshScheduler::UIRefreshScheduler(const SeqLock<UIFrame>& _frames, Component& _window)
+    : frames(_frames), window(_window),
+      timerProbe("UIRefreshScheduler::timerCallback", 1000 / frameRate)
+{
+    startTimerHz(frameRate);
+}
+
+UIRefreshScheduler::~UIRefreshScheduler()
+{
+    stopTimer();
+}
+
+void UIRefreshScheduler::addClient(Client* client)
+{
+    if (std::find(clients.begin(), clients.end(), client) == clients.end())
+        clients.push_back(client);
+}
+
+void UIRefreshScheduler::removeClient(Client* client)
+{
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+}
+
+void UIRefreshScheduler::setFrameRate(int framesPerSecond)
+{
+    frameRate = jlimit(1, 120, framesPerSecond);
+    timerProbe = PaintProfiler::TimerProbe("UIRefreshScheduler::timerCallback", 1000 / frameRate);
+    if (!throttled)
+        startTimerHz(frameRate);
+}
+
+bool UIRefreshScheduler::isWindowVisible() const
+{
+    auto* peer = window.getPeer();
+    return peer != nullptr && !peer->isMinimised() && window.isShowing();
+}
+
+void UIRefreshScheduler::timerCallback()
+{
+    bool visible = isWindowVisible();
+    if (visible == throttled)
+    {
+        throttled = !visible;
+        startTimerHz(throttled ? throttledHz : frameRate);
+        //the time away isn't lag
+        if (!throttled)
+            timerProbe = PaintProfiler::TimerProbe("UIRefreshScheduler::timerCallback", 1000 / frameRate);
+        std::cout << "UIRefreshScheduler::timerCallback - " << (throttled ? "window hidden, throttled" : "window back")
+                  << std::endl;
+    }
+    if (throttled)
+        return;
+
+    timerProbe.beat();
+
+    //one read for every client, they all show the same instant
+    UIFrame frame = frames.read();
+    for (auto* client : clients)
+        client->refresh(frame);
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    UIRefreshScheduler.h
+    Created: 20 Oct 2026 5:41:20am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "DJAudioPlayer.h"
+#include "PaintProfiler.h"
+#include "SeqLock.h"
+
+/** Everything moving on screen, playheads and meters, published by the audio thread once per block **/
+struct UIFrame
+{
+    static constexpr int maxDecks = 4;
+
+    std::array<DeckState, maxDecks> decks;
+    int numDecks = 0;
+    //the master output, with the preview when it plays under the mix
+    MeterLevels master;
+};
+
+/** The one timer that moves the GUI. Once per frame it reads the audio
+    thread's UIFrame in a single lock-free read and hands it to every
+    client, whose repaints then go out together in the next paint pass.
+    Nothing polls the players on its own.
+
+    While the window is minimised or hidden the clients aren't refreshed
+    and the timer drops to a few checks a second until it is back. **/
+class UIRefreshScheduler : private Timer
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** Update to the frame and repaint what changed, on the message thread **/
+        virtual void refresh(const UIFrame& frame) = 0;
+    };
+
+    /** window is checked for being minimised or hidden **/
+    UIRefreshScheduler(const SeqLock<UIFrame>& frames, Component& window);
+    ~UIRefreshScheduler() override;
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    void setFrameRate(int framesPerSecond);
+
+private:
+    void timerCallback() override;
+
+    /** False while the window is minimised, hidden or not on the desktop yet **/
+    bool isWindowVisible() const;
+
+    const SeqLock<UIFrame>& frames;
+    Component& window;
+    std::vector<Client*> clients;
+
+    int frameRate = 60;
+    bool throttled = false;
+
+    PaintProfiler::TimerProbe timerProbe;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UIRefreshScheduler)
+};
@@ -9,6 +9,15 @@
 */
 
 #include "Utilities.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	//set while statics are initialised, before main
+	const auto appStartTime = std::chrono::steady_clock::now();
+}
 
 std::string Utilities::formatTotalTime(double timeInSeconds)
 {
@@ -22,6 +31,25 @@ std::string Utilities::formatTotalTime(double timeInSeconds)
 	return timeStringTotal;
 }
 
+double Utilities::parseTotalTime(const std::string& formatedTime)
+{
+	//min:sec as written by formatTotalTime
+	size_t colon = formatedTime.find(':');
+	if (colon == std::string::npos)
+		return 0.0;
+
+	try
+	{
+		int minutes = std::stoi(formatedTime.substr(0, colon));
+		int seconds = std::stoi(formatedTime.substr(colon + 1));
+		return minutes * 60.0 + seconds;
+	}
+	catch (const std::exception&)
+	{
+		return 0.0;
+	}
+}
+
 std::string Utilities::formatCurrentTime(double timeInSeconds, double pos)
 {
 	//current time display
@@ -33,3 +61,9 @@ std::string Utilities::formatCurrentTime(double timeInSeconds, double pos)
 
 	return timeStringCurrent;
 }
+
+void Utilities::logStartupPhase(const std::string& phase)
+{
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - appStartTime);
+	std::cout << "Startup - " << phase << " after " << elapsed.count() << " ms" << std::endl;
+}
@@ -17,8 +17,14 @@ class Utilities
         /** Static function to transform the total seconds in formated min:sec **/
 		static std::string formatTotalTime(double timeInSeconds);
 
+        /** Static function to read a formated min:sec back as seconds, 0 if it isn't one **/
+		static double parseTotalTime(const std::string& formatedTime);
+
         /** Static function to transform the current reprodution 
         time from seconds to formated min:sec **/
 		static std::string formatCurrentTime(double timeInSeconds, double pos);
 
+        /** Static function to log a startup phase with the milliseconds since the app was started **/
+		static void logStartupPhase(const std::string& phase);
+
 };
@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    WaveformCache.cpp
+    Created: 20 Oct 2026 4:27:35am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+#include "DJAudioPlayer.h"
+#include <cmath>
+
+namespace
+{
+    //both decks, the tracks before them and a few Auto-DJ swaps
+    constexpr size_t maxTracks = 8;
+
+    constexpr int samplesPerTile = WaveformCache::samplesPerColumn * WaveformCache::columnsPerTile;
+
+    //the filters run this far before a tile so its first columns don't show them settling
+    constexpr int preRollSamples = 4096;
+
+    //music gets quieter up the spectrum, weighted so hi-hats colour as much as kicks
+    constexpr float lowWeight = 1.0f;
+    constexpr float midWeight = 2.0f;
+    constexpr float highWeight = 4.0f;
+
+    /** The EQ's low pass, band pass and high pass side by side, one per SIMD
+    lane, so the three bands cost one filter per sample. Same topology and
+    resonance as dsp::StateVariableTPTFilter **/
+    class BandFilterBank
+    {
+    public:
+        using Vec = dsp::SIMDRegister<float>;
+        static_assert(Vec::SIMDNumElements >= 3, "one lane per band");
+
+        explicit BandFilterBank(double sampleRate)
+        {
+            const float cutoffs[]{ DJAudioPlayer::lowCutoffHz, DJAudioPlayer::midCentreHz, DJAudioPlayer::highCutoffHz };
+            const float r2 = MathConstants<float>::sqrt2;
+
+            g = h = s1 = s2 = lowLane = midLane = highLane = Vec::expand(0.0f);
+            for (size_t band = 0; band < 3; ++band)
+            {
+                float cutoff = jmin(cutoffs[band], static_cast<float>(sampleRate) * 0.45f);
+                float gBand = std::tan(MathConstants<float>::pi * cutoff / static_cast<float>(sampleRate));
+                g.set(band, gBand);
+                h.set(band, 1.0f / (1.0f + r2 * gBand + gBand * gBand));
+            }
+            gPlusR2 = g + Vec::expand(r2);
+            lowLane.set(0, 1.0f);
+            midLane.set(1, 1.0f);
+            highLane.set(2, 1.0f);
+        }
+
+        /** Low, mid and high band of the next sample in lanes 0, 1 and 2 **/
+        Vec process(float sample)
+        {
+            Vec yHP = h * (Vec::expand(sample) - s1 * gPlusR2 - s2);
+            Vec yBP = yHP * g + s1;
+            s1 = yHP * g + yBP;
+            Vec yLP = yBP * g + s2;
+            s2 = yBP * g + yLP;
+            return yLP * lowLane + yBP * midLane + yHP * highLane;
+        }
+
+    private:
+        Vec g, h, gPlusR2;
+        Vec s1, s2;
+        Vec lowLane, midLane, highLane;
+    };
+
+    Colour getBandColour(float low, float mid, float high)
+    {
+        float red = low * lowWeight;
+        float green = mid * midWeight;
+        float blue = high * highWeight;
+        float strongest = jmax(red, green, blue);
+        if (strongest <= 0.0f)
+            return Colours::grey;
+
+        //the strongest band at full brightness, a little white so no band goes black
+        return Colour::fromFloatRGBA(0.2f + 0.8f * red / strongest,
+                                     0.2f + 0.8f * green / strongest,
+                                     0.2f + 0.8f * blue / strongest, 1.0f);
+    }
+}
+
+WaveformCache::WaveformCache(DecodedBlockCache& _blockCache)
+    : Thread("WaveformCache"),
+      blockCache(_blockCache)
+{
+    startThread();
+}
+
+WaveformCache::~WaveformCache()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+}
+
+int64 WaveformCache::getNumColumns(const DecodedBlockCache::Track& track)
+{
+    return (track.getLengthInSamples() + samplesPerColumn - 1) / samplesPerColumn;
+}
+
+WaveformCache::TilePtr WaveformCache::getTile(const DecodedBlockCache::TrackPtr& track, int tileIndex)
+{
+    if (track == nullptr || tileIndex < 0)
+        return nullptr;
+
+    const ScopedLock sl(lock);
+    auto it = tracks.find(track.get());
+    if (it == tracks.end())
+    {
+        auto numTiles = static_cast<size_t>((getNumColumns(*track) + columnsPerTile - 1) / columnsPerTile);
+        TrackTiles entry;
+        entry.track = track;
+        entry.tiles.resize(numTiles);
+        entry.queued.resize(numTiles, false);
+        //stamped before evicting, or the new track would be the oldest and evict itself
+        entry.lastUsed = ++useClock;
+        it = tracks.emplace(track.get(), std::move(entry)).first;
+        evictTracks();
+    }
+    else
+    {
+        it->second.lastUsed = ++useClock;
+    }
+
+    TrackTiles& entry = it->second;
+    if (tileIndex >= static_cast<int>(entry.tiles.size()))
+        return nullptr;
+
+    auto index = static_cast<size_t>(tileIndex);
+    if (entry.tiles[index] == nullptr && !entry.queued[index])
+    {
+        entry.queued[index] = true;
+        requests.emplace_back(track, tileIndex);
+        notify();
+    }
+    return entry.tiles[index];
+}
+
+void WaveformCache::evictTracks()
+{
+    while (tracks.size() > maxTracks)
+    {
+        auto oldest = tracks.begin();
+        for (auto it = tracks.begin(); it != tracks.end(); ++it)
+            if (it->second.lastUsed < oldest->second.lastUsed)
+                oldest = it;
+
+        //tiles of it still queued are dropped when they are done
+        tracks.erase(oldest);
+    }
+}
+
+//==============================================================================
+void WaveformCache::run()
+{
+    while (!threadShouldExit())
+    {
+        DecodedBlockCache::TrackPtr track;
+        int tileIndex = -1;
+        {
+            const ScopedLock sl(lock);
+            if (!requests.empty())
+            {
+                track = std::move(requests.back().first);
+                tileIndex = requests.back().second;
+                requests.pop_back();
+            }
+        }
+
+        if (track == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        TilePtr tile = computeTile(track, tileIndex);
+
+        const ScopedLock sl(lock);
+        auto it = tracks.find(track.get());
+        //a tile that couldn't be read stays queued and blank, it isn't retried every frame
+        if (it != tracks.end())
+            it->second.tiles[static_cast<size_t>(tileIndex)] = tile;
+    }
+}
+
+WaveformCache::TilePtr WaveformCache::computeTile(const DecodedBlockCache::TrackPtr& track, int tileIndex)
+{
+    int64 start = static_cast<int64>(tileIndex) * samplesPerTile;
+    int numSamples = static_cast<int>(jmin<int64>(samplesPerTile, track->getLengthInSamples() - start));
+    if (numSamples <= 0)
+        return nullptr;
+    int preRoll = static_cast<int>(jmin<int64>(preRollSamples, start));
+
+    //through the cache, the deck plays these blocks next
+    DecodedBlockReader reader(blockCache, track, true);
+    readBuffer.setSize(track->getNumChannels(), preRollSamples + samplesPerTile, false, false, true);
+    if (!reader.read(&readBuffer, 0, preRoll + numSamples, start - preRoll, true, true))
+        return nullptr;
+
+    //the bands are taken from the mono mix
+    int numChannels = readBuffer.getNumChannels();
+    monoBuffer.resize(static_cast<size_t>(preRollSamples + samplesPerTile));
+    FloatVectorOperations::copyWithMultiply(monoBuffer.data(), readBuffer.getReadPointer(0),
+                                            1.0f / numChannels, preRoll + numSamples);
+    for (int channel = 1; channel < numChannels; ++channel)
+        FloatVectorOperations::addWithMultiply(monoBuffer.data(), readBuffer.getReadPointer(channel),
+                                               1.0f / numChannels, preRoll + numSamples);
+
+    BandFilterBank bands(track->getSampleRate());
+    for (int i = 0; i < preRoll; ++i)
+        bands.process(monoBuffer[static_cast<size_t>(i)]);
+
+    auto tile = std::make_shared<Tile>();
+    tile->columns.resize(static_cast<size_t>((numSamples + samplesPerColumn - 1) / samplesPerColumn));
+    for (size_t column = 0; column < tile->columns.size(); ++column)
+    {
+        int offset = preRoll + static_cast<int>(column) * samplesPerColumn;
+        int count = jmin(samplesPerColumn, preRoll + numSamples - offset);
+
+        Column& peaks = tile->columns[column];
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto range = FloatVectorOperations::findMinAndMax(readBuffer.getReadPointer(channel, offset), count);
+            peaks.min = jmin(peaks.min, range.getStart());
+            peaks.max = jmax(peaks.max, range.getEnd());
+        }
+
+        auto energy = BandFilterBank::Vec::expand(0.0f);
+        const float* mono = monoBuffer.data() + offset;
+        for (int i = 0; i < count; ++i)
+        {
+            auto band = bands.process(mono[i]);
+            energy += band * band;
+        }
+        peaks.low = std::sqrt(energy.get(0) / count);
+        peaks.mid = std::sqrt(energy.get(1) / count);
+        peaks.high = std::sqrt(energy.get(2) / count);
+        peaks.colour = getBandColour(peaks.low, peaks.mid, peaks.high);
+    }
+    return tile;
+}
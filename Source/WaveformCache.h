@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    WaveformCache.h
+    Created: 20 Oct 2026 4:27:35am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+#include <vector>
+#include "DecodedBlockCache.h"
+
+/** Peaks of the tracks on the decks at the zoomed waveform's resolution,
+    shared by both decks. A track is split in tiles of columns computed on a
+    background thread as the playheads come near them, read through the
+    block cache so the audio is decoded once for the deck and its waveform.
+
+    Each column also has the energy of the EQ's low, mid and high bands and
+    the colour they give it, analysed with the peaks through a crossover
+    filter bank, so drawing a column only reads its colour.
+
+    The last few tracks are kept, a track loaded again scrolls from tiles
+    already computed. **/
+class WaveformCache : private Thread
+{
+public:
+    /** Samples of the track per pixel column, about 6ms at 44.1kHz **/
+    static constexpr int samplesPerColumn = 256;
+
+    /** Columns per tile, four decoded blocks **/
+    static constexpr int columnsPerTile = 512;
+
+    struct Column
+    {
+        //over both channels, -1 to 1
+        float min = 0.0f;
+        float max = 0.0f;
+
+        //RMS of the mono mix through the EQ's band filters
+        float low = 0.0f;
+        float mid = 0.0f;
+        float high = 0.0f;
+
+        //red for bass, green for mids, blue for highs
+        Colour colour;
+    };
+
+    struct Tile
+    {
+        //the last tile of a track is shorter
+        std::vector<Column> columns;
+    };
+    using TilePtr = std::shared_ptr<const Tile>;
+
+    explicit WaveformCache(DecodedBlockCache& blockCache);
+    ~WaveformCache() override;
+
+    /** The tile when it is computed. Otherwise nullptr, the tile is queued and
+    shows up in a later call. Never blocks on the audio **/
+    TilePtr getTile(const DecodedBlockCache::TrackPtr& track, int tileIndex);
+
+    static int64 getNumColumns(const DecodedBlockCache::Track& track);
+
+private:
+    struct TrackTiles
+    {
+        //held so the key stays valid
+        DecodedBlockCache::TrackPtr track;
+        std::vector<TilePtr> tiles;
+        std::vector<bool> queued;
+        uint32 lastUsed = 0;
+    };
+
+    void run() override;
+
+    /** Peaks, band energies and colour per column of one tile, blocking **/
+    TilePtr computeTile(const DecodedBlockCache::TrackPtr& track, int tileIndex);
+
+    /** Forget the least recently used tracks over maxTracks. Call with the lock held **/
+    void evictTracks();
+
+    DecodedBlockCache& blockCache;
+
+    CriticalSection lock;
+    std::map<const DecodedBlockCache::Track*, TrackTiles> tracks;
+    uint32 useClock = 0;
+
+    //newest last, the thread takes the newest first as the playheads move on
+    std::vector<std::pair<DecodedBlockCache::TrackPtr, int>> requests;
+
+    //only used by the thread
+    AudioBuffer<float> readBuffer;
+    std::vector<float> monoBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformCache)
+};
@@ -10,10 +10,14 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "WaveformDisplay.h"
+#include "ContentHash.h"
+#include "PaintProfiler.h"
 
 //==============================================================================
 WaveformDisplay::WaveformDisplay(AudioFormatManager & 	formatManagerToUse,
-                                 AudioThumbnailCache & 	cacheToUse) :
+                                 AudioThumbnailCache & 	cacheToUse,
+                                 DecodedBlockCache & 	blockCacheToUse) :
+                                 blockCache(blockCacheToUse),
                                  audioThumb(1000, formatManagerToUse, cacheToUse), 
                                  fileLoaded(false), 
                                  position(0),
@@ -32,6 +36,7 @@ WaveformDisplay::~WaveformDisplay()
 
 void WaveformDisplay::paint (Graphics& g)
 {
+    PaintProfiler::Scope profile("WaveformDisplay::paint");
     g.fillAll (Colours::black.withAlpha(0.5f));
 
     // Draw an outline around the component
@@ -91,9 +96,31 @@ void WaveformDisplay::resized()
 }
 
 void WaveformDisplay::loadURL(URL audioURL)
+{
+  //local files are read through the shared block cache, the deck playing it reuses the blocks
+  auto track = audioURL.isLocalFile() ? blockCache.openTrack(audioURL.getLocalFile()) : nullptr;
+  int64 hash = track != nullptr ? static_cast<int64>(ContentHash::ofFile(audioURL.getLocalFile())) : 0;
+  loadTrack(audioURL, track, hash);
+}
+
+void WaveformDisplay::loadTrack(URL audioURL, DecodedBlockCache::TrackPtr track, int64 thumbnailHash)
 {
   audioThumb.clear();
-  fileLoaded  = audioThumb.setSource(new URLInputSource(audioURL));
+  if (track != nullptr)
+  {
+    //thumbnails are cached by content, a moved or renamed file finds its waveform again
+    //the overview reads the whole track, it uses blocks already cached but doesn't
+    //fill the cache, that would push out the blocks around the deck's playhead
+    File file = audioURL.getLocalFile();
+    audioThumb.setReader(new DecodedBlockReader(blockCache, track, false),
+                         thumbnailHash != 0 ? thumbnailHash
+                                            : file.hashCode64() ^ file.getLastModificationTime().toMilliseconds());
+    fileLoaded = true;
+  }
+  else
+  {
+    fileLoaded = audioThumb.setSource(new URLInputSource(audioURL));
+  }
   fileName = audioURL.getFileName().toStdString();
   if (fileLoaded)
   {
@@ -115,13 +142,15 @@ void WaveformDisplay::changeListenerCallback (ChangeBroadcaster *source)
 
 void WaveformDisplay::setPositionRelative(double pos)
 {
-  if (pos != position)
+  //called every frame, only a playhead that moved a pixel or a clock that ticked is repainted
+  double totalLength = audioThumb.getTotalLength();
+  bool moved = roundToInt(pos * getWidth()) != roundToInt(position * getWidth());
+  bool ticked = static_cast<int>(pos * totalLength) != static_cast<int>(position * totalLength);
+  position = pos;
+  if (moved || ticked)
   {
-    position = pos;
     repaint();
   }
-
-  
 }
 
 
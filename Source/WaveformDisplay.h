@@ -13,6 +13,7 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "DJAudioPlayer.h"
 #include "Utilities.h"
+#include "DecodedBlockCache.h"
 
 //==============================================================================
 /*
@@ -22,7 +23,8 @@ class WaveformDisplay    : public Component,
 {
 public:
     WaveformDisplay( AudioFormatManager & 	formatManagerToUse,
-                    AudioThumbnailCache & 	cacheToUse );
+                    AudioThumbnailCache & 	cacheToUse,
+                    DecodedBlockCache & 	blockCacheToUse );
     ~WaveformDisplay();
 
     void paint (Graphics&) override;
@@ -32,6 +34,10 @@ public:
 
     void loadURL(URL audioURL);
 
+    /** show a track already opened in the block cache, the waveform is looked up
+        by thumbnailHash so one built ahead of time shows straight away */
+    void loadTrack(URL audioURL, DecodedBlockCache::TrackPtr track, int64 thumbnailHash);
+
     /** Get the playhead width**/
 	int getPlayHeadWidth() { return playHeadWidth; }
 
@@ -39,6 +45,7 @@ public:
     void setPositionRelative(double pos);
 
 private:
+    DecodedBlockCache& blockCache;
     AudioThumbnail audioThumb;
 	std::string fileName = "";
     bool fileLoaded; 
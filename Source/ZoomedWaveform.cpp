@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    ZoomedWaveform.cpp
+    Created: 20 Oct 2026 4:27:35am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ZoomedWaveform.h"
+#include "PaintProfiler.h"
+#include <algorithm>
+
+namespace
+{
+    const Colour backgroundColour{ 0xFF151515 };
+}
+
+ZoomedWaveform::ZoomedWaveform(WaveformCache& _cache)
+    : cache(_cache)
+{
+    //the image covers every pixel, nothing behind it is repainted each frame
+    setOpaque(true);
+}
+
+ZoomedWaveform::~ZoomedWaveform()
+{
+}
+
+void ZoomedWaveform::setTrack(DecodedBlockCache::TrackPtr newTrack)
+{
+    track = std::move(newTrack);
+    numColumns = track != nullptr ? WaveformCache::getNumColumns(*track) : 0;
+    stripValid = false;
+    missingTiles.clear();
+    repaint();
+}
+
+void ZoomedWaveform::paint(Graphics& g)
+{
+    PaintProfiler::Scope profile("ZoomedWaveform::paint");
+    if (track == nullptr || !stripValid)
+    {
+        g.fillAll(backgroundColour);
+        return;
+    }
+
+    g.drawImageAt(strip, 0, 0);
+
+    //the playhead stays in the middle, the track moves under it
+    g.setColour(Colours::lightgreen.withAlpha(0.9f));
+    g.fillRect(getWidth() / 2 - 1, 0, 2, getHeight());
+}
+
+void ZoomedWaveform::resized()
+{
+    strip = Image(Image::RGB, jmax(1, getWidth()), jmax(1, getHeight()), false);
+    stripValid = false;
+    missingTiles.clear();
+}
+
+void ZoomedWaveform::setPlayhead(int64 sample)
+{
+    if (track == nullptr || !isShowing())
+        return;
+
+    int64 firstColumn = sample / WaveformCache::samplesPerColumn - strip.getWidth() / 2;
+    bool changed = !stripValid || firstColumn != stripFirstColumn;
+    scrollTo(firstColumn);
+    if (drawArrivedTiles())
+        changed = true;
+
+    //the tile after the right edge is computed before it scrolls in
+    int64 nextColumn = stripFirstColumn + strip.getWidth() + WaveformCache::columnsPerTile / 2;
+    if (nextColumn < numColumns)
+        cache.getTile(track, static_cast<int>(nextColumn / WaveformCache::columnsPerTile));
+
+    if (changed)
+        repaint();
+}
+
+void ZoomedWaveform::scrollTo(int64 firstColumn)
+{
+    int width = strip.getWidth();
+    int height = strip.getHeight();
+    int64 shift = firstColumn - stripFirstColumn;
+
+    //a seek or a new track, nothing on screen can be reused
+    if (!stripValid || std::abs(shift) >= width)
+    {
+        stripFirstColumn = firstColumn;
+        missingTiles.clear();
+        drawColumns(0, width);
+        stripValid = true;
+        return;
+    }
+
+    int pixels = static_cast<int>(shift);
+    stripFirstColumn = firstColumn;
+    if (pixels > 0)
+    {
+        strip.moveImageSection(0, 0, pixels, 0, width - pixels, height);
+        drawColumns(width - pixels, width);
+    }
+    else if (pixels < 0)
+    {
+        strip.moveImageSection(-pixels, 0, 0, 0, width + pixels, height);
+        drawColumns(0, -pixels);
+    }
+}
+
+void ZoomedWaveform::drawColumns(int begin, int end)
+{
+    if (begin >= end)
+        return;
+
+    int height = strip.getHeight();
+    float halfHeight = height * 0.5f;
+    Image::BitmapData pixels(strip, begin, 0, end - begin, height, Image::BitmapData::writeOnly);
+
+    WaveformCache::TilePtr tile;
+    int tileIndex = -1;
+    for (int x = begin; x < end; ++x)
+    {
+        int64 column = stripFirstColumn + x;
+        const WaveformCache::Column* peaks = nullptr;
+        if (column >= 0 && column < numColumns)
+        {
+            int index = static_cast<int>(column / WaveformCache::columnsPerTile);
+            if (index != tileIndex)
+            {
+                tileIndex = index;
+                tile = cache.getTile(track, tileIndex);
+                if (tile == nullptr && std::find(missingTiles.begin(), missingTiles.end(), tileIndex) == missingTiles.end())
+                    missingTiles.push_back(tileIndex);
+            }
+
+            auto offset = static_cast<size_t>(column % WaveformCache::columnsPerTile);
+            if (tile != nullptr && offset < tile->columns.size())
+                peaks = &tile->columns[offset];
+        }
+
+        //an empty column is blank, a quiet one still gets its centre pixel
+        int top = height, bottom = -1;
+        Colour colour = backgroundColour;
+        if (peaks != nullptr)
+        {
+            top = jlimit(0, height - 1, roundToInt(halfHeight - peaks->max * halfHeight));
+            bottom = jlimit(0, height - 1, roundToInt(halfHeight - peaks->min * halfHeight));
+            //worked out with the tile, nothing is filtered while drawing
+            colour = peaks->colour;
+        }
+
+        for (int y = 0; y < height; ++y)
+            pixels.setPixelColour(x - begin, y, y >= top && y <= bottom ? colour : backgroundColour);
+    }
+}
+
+bool ZoomedWaveform::drawArrivedTiles()
+{
+    std::vector<std::pair<int, int>> arrived;
+    int width = strip.getWidth();
+    for (auto it = missingTiles.begin(); it != missingTiles.end();)
+    {
+        int64 tileStart = static_cast<int64>(*it) * WaveformCache::columnsPerTile;
+        int begin = static_cast<int>(jmax<int64>(0, tileStart - stripFirstColumn));
+        int end = static_cast<int>(jmin<int64>(width, tileStart + WaveformCache::columnsPerTile - stripFirstColumn));
+
+        //scrolled out of view, it is looked up again if it comes back
+        if (begin >= end)
+        {
+            it = missingTiles.erase(it);
+        }
+        else if (cache.getTile(track, *it) != nullptr)
+        {
+            arrived.emplace_back(begin, end);
+            it = missingTiles.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (const auto& columns : arrived)
+        drawColumns(columns.first, columns.second);
+    return !arrived.empty();
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ZoomedWaveform.h
+    Created: 20 Oct 2026 4:27:35am
+    Author:  guico
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "WaveformCache.h"
+
+/** Close-up of the waveform around the playhead, scrolling with the track at
+    frame rate while the overview above it shows the whole track. The deck
+    moves it once per frame from the UIRefreshScheduler.
+
+    The waveform is kept in an image one pixel column per WaveformCache
+    column. Each frame the image is shifted by whole columns and only the
+    columns that scrolled in are drawn from the cached tiles, so a frame
+    costs a few columns and one blit however wide the deck is. Columns of a
+    tile not computed yet are drawn once it is. **/
+class ZoomedWaveform : public Component
+{
+public:
+    explicit ZoomedWaveform(WaveformCache& cache);
+    ~ZoomedWaveform() override;
+
+    /** Show the track opened on the deck, nullptr clears the view **/
+    void setTrack(DecodedBlockCache::TrackPtr newTrack);
+
+    /** Centre the view on the sample, repainting only if it scrolled **/
+    void setPlayhead(int64 sample);
+
+    void paint(Graphics& g) override;
+    void resized() override;
+
+private:
+    /** Move the image to start at firstColumn of the track, drawing only what scrolled in **/
+    void scrollTo(int64 firstColumn);
+
+    /** Draw image columns [begin, end) from the tiles, the ones not computed yet blank **/
+    void drawColumns(int begin, int end);
+
+    /** Draw the columns of tiles computed since they were drawn blank, true if any **/
+    bool drawArrivedTiles();
+
+    WaveformCache& cache;
+    DecodedBlockCache::TrackPtr track;
+    int64 numColumns = 0;
+
+    Image strip;
+    //track column shown at the left edge of strip
+    int64 stripFirstColumn = 0;
+    bool stripValid = false;
+
+    //tiles in view drawn blank while they were computed
+    std::vector<int> missingTiles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ZoomedWaveform)
+};